@@ -128,6 +128,7 @@ void INT33_StartUp(void);
 void INT13_StartUp(void);
 
 bool BIOS_AddKeyToBuffer(Bit16u code);
+Bitu BIOS_KeyboardBufferFree(void);
 
 void INT10_ReloadRomFonts();
 
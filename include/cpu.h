@@ -70,6 +70,7 @@ extern CPU_Decoder * cpudecoder;
 
 Bits CPU_Core_Normal_Run(void);
 Bits CPU_Core_Normal_Trap_Run(void);
+Bits CPU_Core_Normal_Nested_Run(void);
 Bits CPU_Core_Simple_Run(void);
 Bits CPU_Core_Simple_Trap_Run(void);
 Bits CPU_Core_Full_Run(void);
@@ -134,6 +135,7 @@ bool CPU_CLI(void);
 bool CPU_STI(void);
 
 bool CPU_IO_Exception(Bitu port,Bitu size);
+void CPU_TableCachesInvalidate(void);
 void CPU_RunException(void);
 
 void CPU_ENTER(bool use32,Bitu bytes,Bitu level);
@@ -421,6 +423,9 @@ public:
 	Bitu SLDT(void)	{
 		return ldt_value;
 	}
+	PhysPt GetLDTBase(void) {
+		return ldt_base;
+	}
 	bool LLDT(Bitu value)	{
 		if ((value&0xfffc)==0) {
 			ldt_value=0;
@@ -21,6 +21,7 @@
 #define DOSBOX_DOS_SYSTEM_H
 
 #include <vector>
+#include <string>
 #ifndef DOSBOX_DOSBOX_H
 #include "dosbox.h"
 #endif
@@ -128,9 +129,13 @@ public:
 	bool UpdateDateTimeFromHost(void);   
 	void FlagReadOnlyMedium(void);
 	void Flush(void);
+	bool CopyTo(localFile * target);
+	void SetPoolName(const char * host_name) { pool_name = host_name; }
+	const char * GetPoolName(void) { return pool_name.c_str(); }
 	FILE * fhandle; //todo handle this properly
 private:
 	bool read_only_medium;
+	std::string pool_name;	// read-only host handle, kept open after close
 	enum { NONE,READ,WRITE } last_action;
 };
 
@@ -19,6 +19,10 @@
 #ifndef DOSBOX_KEYBOARD_H
 #define DOSBOX_KEYBOARD_H
 
+#ifndef DOSBOX_DOSBOX_H
+#include "dosbox.h"
+#endif
+
 enum KBD_KEYS {
 	KBD_NONE,
 	KBD_1,	KBD_2,	KBD_3,	KBD_4,	KBD_5,	KBD_6,	KBD_7,	KBD_8,	KBD_9,	KBD_0,		
@@ -48,6 +52,18 @@ enum KBD_KEYS {
 };
 
 void KEYBOARD_ClrBuffer(void);
+/* Keys that arrive while the guest doesn't empty the controller buffer, for
+ * instance in a pause loop with interrupts off, are held back and not dropped */
 void KEYBOARD_AddKey(KBD_KEYS keytype,bool pressed);
 
+/* Scripted input: queue key strokes of any length, they are fed to the
+ * controller only as fast as the guest consumes them. With bios_direct set,
+ * plain text is stored straight into the BIOS buffer while the guest waits
+ * in INT 16h. */
+void KEYBOARD_QueueKey(KBD_KEYS keytype,bool shift=false);
+bool KEYBOARD_QueueText(const char * text,bool bios_direct=false);
+void KEYBOARD_ClrScript(void);
+Bitu KEYBOARD_ScriptPending(void);
+void KEYBOARD_ScriptBiosPoll(void);
+
 #endif
@@ -72,8 +72,11 @@ public:
 	void AddSamples_s16u_nonnative(Bitu len, const Bit16u * data);
 	void AddSamples_m32_nonnative(Bitu len, const Bit32s * data);
 	void AddSamples_s32_nonnative(Bitu len, const Bit32s * data);
+	void AddSamples_mfloat(Bitu len, const float * data);
+	void AddSamples_sfloat(Bitu len, const float * data);
 	
 	void AddStretched(Bitu len,Bit16s * data);		//Strech block up into needed data
+	void DiscardSamples(Bitu len);		//Account for samples like AddSamples without mixing them
 
 	void FillUp(void);
 	void Enable(bool _yesno);
@@ -100,6 +103,10 @@ public:
 	bool enabled;
 	bool last_samples_were_stereo;
 	bool last_samples_were_silence;
+	//Output only depends on the device state, so it doesn't have to be mixed when nobody listens.
+	//The handler still runs to keep the device stepping, its samples are dropped while discard is set
+	bool synthesized;
+	bool discard;
 	MixerChannel * next;
 };
 
@@ -129,6 +136,7 @@ void PCSPEAKER_SetType(Bitu mode);
 auto MIXER_RETRO_GetAvailableFrames() noexcept -> Bitu;
 auto MIXER_RETRO_GetFrequency() -> Bit32u;
 void MIXER_CallBack(void* userdata, uint8_t* stream, int len);
+void MIXER_RETRO_SkipSynthesis(bool skip);
 #endif
 
 #endif
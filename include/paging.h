@@ -96,6 +96,14 @@ void PAGING_MapPage(Bitu lin_page,Bitu phys_page);
 bool PAGING_MakePhysPage(Bitu & page);
 bool PAGING_ForcePageInit(Bitu lin_addr);
 
+/* Bulk string operations, size is the element size and dir the direction flag.
+   The indexes wrap with mask and count is lowered by the elements done */
+void PAGING_StringMove(PhysPt dst_base,Bitu & di,PhysPt src_base,Bitu & si,Bitu & count,Bitu size,Bits dir,Bitu mask);
+void PAGING_StringStore(PhysPt dst_base,Bitu & di,Bit32u val,Bitu & count,Bitu size,Bits dir,Bitu mask);
+Bit32u PAGING_StringLoad(PhysPt src_base,Bitu & si,Bit32u val,Bitu & count,Bitu size,Bits dir,Bitu mask);
+Bitu PAGING_StringScan(PhysPt dst_base,Bitu & di,Bit32u acc,bool rep_zero,Bit32u & val,Bitu & count,Bitu size,Bits dir,Bitu mask);
+Bitu PAGING_StringCompare(PhysPt dst_base,Bitu & di,PhysPt src_base,Bitu & si,bool rep_zero,Bit32u & val1,Bit32u & val2,Bitu & count,Bitu size,Bits dir,Bitu mask);
+
 void MEM_SetLFB(Bitu page, Bitu pages, PageHandler *handler, PageHandler *mmiohandler);
 void MEM_SetPageHandler(Bitu phys_page, Bitu pages, PageHandler * handler);
 void MEM_ResetPageHandler(Bitu phys_page, Bitu pages);
@@ -64,6 +64,8 @@ typedef struct {
 		int max;
 		Bitu index;
 		Bit8u hadSkip[RENDER_SKIP_CACHE];
+		bool timeDraw;
+		double drawTime;
 	} frameskip;
 	struct {
 		Bitu size;
@@ -91,6 +93,7 @@ typedef struct {
 	bool aspect;
 	bool fullFrame;
 	bool forceUpdate;
+	bool discard;
 } Render_t;
 
 extern Render_t render;
@@ -101,6 +104,7 @@ void RENDER_EndUpdate(bool abort);
 void RENDER_SetPal(Bit8u entry,Bit8u red,Bit8u green,Bit8u blue);
 bool RENDER_GetForceUpdate(void);
 void RENDER_SetForceUpdate(bool);
+void RENDER_SetDiscard(bool discard);
 
 
 #endif
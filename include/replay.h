@@ -0,0 +1,46 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef DOSBOX_REPLAY_H
+#define DOSBOX_REPLAY_H
+
+#ifndef DOSBOX_DOSBOX_H
+#include "dosbox.h"
+#endif
+
+/* Input recording and replay. Host input passes through these filters before
+ * it reaches the emulated devices; they stamp it with the emulated time when
+ * recording and return false when live input has to be dropped because a
+ * recording is being replayed. */
+bool REPLAY_Key(Bitu keytype,bool pressed);
+bool REPLAY_MouseMoved(float xrel,float yrel,float x,float y,bool emulate);
+bool REPLAY_MouseButton(Bit8u button,bool pressed);
+bool REPLAY_JoystickEnable(Bitu which,bool enabled);
+bool REPLAY_JoystickButton(Bitu which,Bitu num,bool pressed);
+bool REPLAY_JoystickMove(Bitu which,Bitu axis,float val);
+
+/* True while recording or replaying; timing has to stay host independent */
+bool REPLAY_Active(void);
+
+/* Local wall clock time for the guest. While recording or replaying it runs
+ * on emulated time from the start of the recording; returns false when the
+ * host clock is to be used. */
+struct tm;
+bool REPLAY_LocalTime(struct tm & loctime,Bit32u & milli);
+
+#endif
@@ -7,8 +7,15 @@
 #include "dos_inc.h"
 #include "dosbox.h"
 #include "libretro_dosbox.h"
+#include "libretro_message.h"
 #include "log.h"
 #include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -22,6 +29,225 @@ static bool is_ejected = false;
 
 } // namespace state
 
+// Images in the swap list are read ahead on a worker thread as soon as the frontend hands them to
+// us. That way the file system and the OS cache have done the slow part by the time the image is
+// mounted. The mount itself still decides whether an image is usable, a failed preparation only
+// means it gets no head start.
+namespace prepare {
+
+struct result
+{
+    bool ok = false;
+    std::string error;
+};
+
+static std::map<std::filesystem::path, std::shared_future<result>> jobs;
+// Jobs of images that left the swap list. Destroying the last future of a std::async job waits
+// for it, so they are only dropped once they are done.
+static std::vector<std::shared_future<result>> retired;
+
+// Read a range of a file so that mounting it later does not wait for the disk.
+static auto read_ahead(std::ifstream& file, const std::streamoff offset, const std::size_t len)
+    -> bool
+{
+    std::vector<char> buffer(len);
+    file.seekg(offset);
+    file.read(buffer.data(), len);
+    return file.gcount() > 0;
+}
+
+static auto prepare_floppy(const std::filesystem::path& path) -> result
+{
+    const auto size = std::filesystem::file_size(path);
+    if (size > 2880 * 1024) {
+        return {false, "Mounting HDD images is currently not supported."};
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file || !read_ahead(file, 0, size)) {
+        return {false, "Failed to read image."};
+    }
+    return {true, {}};
+}
+
+static auto prepare_iso(const std::filesystem::path& path, const std::size_t sector_size,
+                        const std::size_t header) -> result
+{
+    constexpr std::size_t pvd_sector = 16;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return {false, "Failed to open image."};
+    }
+
+    // Primary volume descriptor, then the root directory it points to.
+    std::array<unsigned char, 2048> pvd{};
+    file.seekg(pvd_sector * sector_size + header);
+    file.read(reinterpret_cast<char*>(pvd.data()), pvd.size());
+    if (file.gcount() != static_cast<std::streamsize>(pvd.size())) {
+        return {false, "Image is too short."};
+    }
+    if (pvd[0] != 1 || std::memcmp(&pvd[1], "CD001", 5) != 0) {
+        // Not an ISO 9660 data track. Could be an audio disc, leave it to the mount code.
+        return {true, {}};
+    }
+    const unsigned char* const root = &pvd[156];
+    const std::size_t extent = root[2] | (root[3] << 8) | (root[4] << 16) | (root[5] << 24);
+    std::size_t length = root[10] | (root[11] << 8) | (root[12] << 16) | (root[13] << 24);
+    length = std::min<std::size_t>(length, 64 * 1024);
+    const std::size_t sectors = (length + 2047) / 2048;
+    file.clear();
+    read_ahead(file, extent * sector_size, sectors * sector_size);
+    return {true, {}};
+}
+
+// Host side of CDROM_Interface_Image::GetRealFileName(): the name as given, relative to the cue
+// sheet, and both again with DOS directory separators. The DOS drive lookup isn't safe to do off
+// the emulation thread.
+static auto find_track(const std::string& name, const std::filesystem::path& cue_dir)
+    -> std::filesystem::path
+{
+    std::vector<std::filesystem::path> candidates{name, cue_dir / name};
+#ifndef _WIN32
+    std::string unix_name = name;
+    std::replace(unix_name.begin(), unix_name.end(), '\\', '/');
+    candidates.emplace_back(unix_name);
+    candidates.emplace_back(cue_dir / unix_name);
+#endif
+    for (const auto& candidate : candidates) {
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(candidate, ec)) {
+            return candidate;
+        }
+    }
+    return {};
+}
+
+static auto prepare_cue(const std::filesystem::path& path) -> result
+{
+    std::ifstream cue(path);
+    if (!cue) {
+        return {false, "Failed to open cue sheet."};
+    }
+
+    std::string line;
+    bool first_file = true;
+    while (std::getline(cue, line)) {
+        const auto keyword = line.find_first_not_of(" \t");
+        if (keyword == std::string::npos || lower_case(line.substr(keyword, 5)) != "file ") {
+            continue;
+        }
+        std::string name;
+        const auto open_quote = line.find('"', keyword);
+        const auto close_quote = open_quote == std::string::npos
+                                     ? std::string::npos
+                                     : line.find('"', open_quote + 1);
+        if (close_quote != std::string::npos) {
+            name = line.substr(open_quote + 1, close_quote - open_quote - 1);
+        } else {
+            const auto start = line.find_first_not_of(" \t", keyword + 5);
+            const auto end = line.find_first_of(" \t", start);
+            if (start != std::string::npos) {
+                name = line.substr(start, end - start);
+            }
+        }
+        if (name.empty()) {
+            continue;
+        }
+
+        const auto track = find_track(name, path.parent_path());
+        if (track.empty()) {
+            // Only the mount can look on the DOS drives, let it deal with the track.
+            retro::logDebug("Track file {} not found on the host, not reading ahead.", name);
+            first_file = false;
+            continue;
+        }
+        std::ifstream file(track, std::ios::binary);
+        if (first_file) {
+            // The data track is normally the first one and stored as raw sectors.
+            const auto raw = lower_case(line).find("binary") != std::string::npos;
+            file.close();
+            auto result = raw ? prepare_iso(track, 2352, 16) : prepare_iso(track, 2048, 0);
+            if (!result.ok) {
+                return result;
+            }
+            first_file = false;
+        } else {
+            // Audio tracks: the decoders read the headers to find the track length.
+            read_ahead(file, 0, 64 * 1024);
+        }
+    }
+    return {true, {}};
+}
+
+static auto run(const std::filesystem::path path) -> result
+{
+    try {
+        if (!std::filesystem::exists(path)) {
+            return {false, "Image does not exist."};
+        }
+        const auto extension = lower_case(path.extension().string());
+        if (extension == ".img") {
+            return prepare_floppy(path);
+        }
+        if (extension == ".iso") {
+            return prepare_iso(path, 2048, 0);
+        }
+        if (extension == ".cue") {
+            return prepare_cue(path);
+        }
+        return {false, fmt::format("Unsupported disk image {}.", path.extension().string())};
+    }
+    catch (const std::exception& e) {
+        return {false, e.what()};
+    }
+}
+
+static auto is_done(const std::shared_future<result>& job) -> bool
+{
+    return job.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+static void start(const std::filesystem::path& path)
+{
+    retired.erase(std::remove_if(retired.begin(), retired.end(), is_done), retired.end());
+    if (path.empty()) {
+        return;
+    }
+    // A failed image may have been fixed in the meantime, so it gets checked again.
+    if (const auto job = jobs.find(path);
+        job != jobs.end() && (!is_done(job->second) || job->second.get().ok))
+    {
+        return;
+    }
+    jobs[path] = std::async(std::launch::async, run, path).share();
+}
+
+static void forget(const std::filesystem::path& path)
+{
+    if (std::count(state::images.begin(), state::images.end(), path) != 0) {
+        return;
+    }
+    if (const auto job = jobs.find(path); job != jobs.end()) {
+        if (!is_done(job->second)) {
+            retired.push_back(std::move(job->second));
+        }
+        jobs.erase(job);
+    }
+}
+
+// Wait for the image to be prepared. Failed results are not kept.
+static auto wait(const std::filesystem::path& path) -> result
+{
+    start(path);
+    const auto job = jobs.find(path);
+    auto prepared = job->second.get();
+    if (!prepared.ok) {
+        jobs.erase(job);
+    }
+    return prepared;
+}
+
+} // namespace prepare
+
 namespace cb {
 
 static RETRO_CALLCONV auto get_num_images() -> unsigned int
@@ -49,7 +275,25 @@ static RETRO_CALLCONV auto set_eject_state(const bool ejected) -> bool
     if (ejected) {
         return unmount(state::images.at(get_image_index()));
     }
-    return disk_control::mount(state::images.at(get_image_index()));
+
+    const auto& image = state::images.at(get_image_index());
+    if (image.empty()) {
+        retro::logWarn("No image in the selected disk slot.");
+        state::is_ejected = true;
+        return false;
+    }
+    // Normally the worker is long done with the image by now.
+    if (const auto prepared = prepare::wait(image); !prepared.ok) {
+        retro::logWarn("Could not prepare {}: {} Mounting it anyway.", image.filename(),
+                       prepared.error);
+    }
+    if (!disk_control::mount(image)) {
+        retro::showOsdError(
+            fmt::format("Failed to mount {}.", image.filename()), RETRO_MESSAGE_TYPE_NOTIFICATION);
+        state::is_ejected = true;
+        return false;
+    }
+    return true;
 }
 
 static RETRO_CALLCONV auto set_image_index(const unsigned int index) -> bool
@@ -79,13 +323,18 @@ static RETRO_CALLCONV auto replace_image_index(
     }
 
     if (info == nullptr) {
+        const auto removed = state::images.at(index);
         state::images.erase(state::images.begin() + index);
+        prepare::forget(removed);
         if (get_image_index() >= get_num_images() && get_num_images() > 0) {
             set_image_index(get_num_images() - 1);
         }
         return true;
     }
+    const auto replaced = state::images.at(index);
     state::images.at(index) = info->path;
+    prepare::forget(replaced);
+    prepare::start(state::images.at(index));
     return true;
 }
 
@@ -128,6 +377,12 @@ void disk_control::init(const retro_environment_t env_cb)
     }
 }
 
+void disk_control::reset()
+{
+    prepare::jobs.clear();
+    prepare::retired.clear();
+}
+
 static auto mount_floppy_image(const char drive_letter, const std::filesystem::path& path) -> bool
 {
     constexpr Bit8u media_id = 0xF0;
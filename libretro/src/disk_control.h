@@ -8,6 +8,8 @@ namespace disk_control {
 
 void init(const retro_environment_t cb);
 auto mount(std::filesystem::path image) -> bool;
+// Drop the prepared images. Waits for jobs that are still running.
+void reset();
 
 } // namespace disk_control
 
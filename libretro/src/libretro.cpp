@@ -34,6 +34,7 @@
 #endif
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <cstdarg>
 #include <cstdlib>
@@ -60,7 +61,6 @@ bool startup_state_numlock;
 static constexpr float internal_sync_fps = 60.0f;
 
 bool autofire;
-static bool dosbox_initialiazed = false;
 
 std::set<std::string> disabled_dosbox_variables;
 std::set<std::string> disabled_core_options;
@@ -72,23 +72,18 @@ SVGACards svgaCard = SVGA_None;
 /* input variables */
 std::array<bool, RETRO_INPUT_PORTS_MAX> gamepad{}; // True means gamepad, false means joystick.
 std::array<bool, RETRO_INPUT_PORTS_MAX> connected;
-static bool force_2axis_joystick = false;
 int mouse_emu_deadzone = 0;
 float mouse_speed_factor_x = 1.0;
 float mouse_speed_factor_y = 1.0;
 float mouse_speed_hack_factor = 1.0;
-static bool enable_mouse_speed_clamp = false;
 
 /* core option variables */
 bool run_synced = true;
-static bool use_frame_duping = true;
-static bool use_spinlock = false;
 
 /* directories */
 std::filesystem::path retro_save_directory;
 std::filesystem::path retro_system_directory;
 std::filesystem::path load_game_directory;
-static std::filesystem::path retro_content_directory;
 static const std::string retro_library_name = "DOSBox-core";
 
 /* libretro variables */
@@ -99,11 +94,55 @@ retro_environment_t environ_cb;
 retro_perf_callback perf_cb;
 
 /* DOSBox state */
-static std::filesystem::path game_path;
-static std::filesystem::path config_path;
 bool dosbox_exit;
 bool frontend_exit;
-static bool fast_forward_status = false;
+
+/* Adaptive frameskip. The host time of each emulated frame is split into drawing (VGA_DrawPart
+ * and the scalers) and the rest, and frames are skipped when drawing every one of them would
+ * not fit in the frame time the frontend gives us. */
+static constexpr int max_auto_frameskip = 5;
+struct AutoFrameskip
+{
+    double emu_time = 0;  // smoothed host time per frame without drawing
+    double draw_time = 0; // smoothed host time of drawing one frame
+    int settle = 0;       // frames to wait before the next change
+    bool audio_active = false;
+    unsigned audio_occupancy = 0;
+    bool audio_underrun = false;
+};
+
+/* State of the frontend glue for the machine. The emulator core keeps its own state in globals,
+ * so there is one machine per process and this is a single object shared by the frontend and
+ * emulator threads.
+ */
+struct MachineContext
+{
+    bool dosbox_initialiazed = false;
+    bool force_2axis_joystick = false;
+    bool enable_mouse_speed_clamp = false;
+    bool use_frame_duping = true;
+    bool use_spinlock = false;
+    bool use_auto_frameskip = false;
+    std::filesystem::path retro_content_directory;
+    std::filesystem::path game_path;
+    std::filesystem::path config_path;
+    bool fast_forward_status = false;
+    // Refresh rate the frontend was last told about.
+    float frontend_fps = 0;
+    std::chrono::steady_clock::time_point fast_forward_frame_time;
+    AutoFrameskip auto_frameskip;
+    // Pending overlay mount.
+    bool mount_overlay = true;
+    // Thread we run dosbox in.
+    std::thread emu_thread;
+};
+
+static MachineContext machine_context;
+
+static auto context() -> MachineContext&
+{
+    return machine_context;
+}
 
 /* audio variables */
 struct retro_midi_interface retro_midi_interface;
@@ -128,11 +167,6 @@ void retro_set_input_state(retro_input_state_t cb)
     input_cb = cb;
 }
 
-// Pending overlay mount.
-static bool mount_overlay = true;
-
-// Thread we run dosbox in.
-static std::thread emu_thread;
 
 /* helper functions */
 
@@ -239,7 +273,7 @@ auto update_dosbox_variable(
     const std::string& val_string) -> bool
 {
     bool ret = false;
-    if (dosbox_initialiazed && compare_dosbox_variable(section_string, var_string, val_string)) {
+    if (context().dosbox_initialiazed && compare_dosbox_variable(section_string, var_string, val_string)) {
         return false;
     }
 
@@ -299,7 +333,7 @@ void update_mouse_speed_fix(const int gfx_height)
 
 void set_mouse_speed_clamp(const bool enable)
 {
-    enable_mouse_speed_clamp = enable;
+    context().enable_mouse_speed_clamp = enable;
 }
 
 static void update_gfx_mode(const bool change_fps)
@@ -313,6 +347,8 @@ static void update_gfx_mode(const bool change_fps)
         cb_error = !environ_cb(RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO, &new_av_info);
         if (cb_error) {
             retro::logError("SET_SYSTEM_AV_INFO failed.");
+        } else {
+            context().frontend_fps = render.src.fps;
         }
     } else {
         cb_error = !environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &new_av_info);
@@ -695,6 +731,48 @@ static void update_log_verbosity()
     }
 }
 
+static void RETRO_CALLCONV
+audio_buffer_status_cb(const bool active, const unsigned occupancy, const bool underrun_likely)
+{
+    context().auto_frameskip.audio_active = active;
+    context().auto_frameskip.audio_occupancy = occupancy;
+    context().auto_frameskip.audio_underrun = underrun_likely;
+}
+
+static void update_auto_frameskip(const double frame_time)
+{
+    auto& fs = context().auto_frameskip;
+    const double draw_time = render.frameskip.drawTime;
+    render.frameskip.drawTime = 0;
+
+    fs.emu_time += (std::max(frame_time - draw_time, 0.0) - fs.emu_time) * 0.1;
+    if (draw_time > 0) {
+        fs.draw_time += (draw_time - fs.draw_time) * 0.1;
+    }
+    if (fs.settle > 0) {
+        --fs.settle;
+        return;
+    }
+
+    // Skipping only helps when drawing costs something.
+    if (context().frontend_fps <= 0 || fs.draw_time <= 0) {
+        return;
+    }
+    const double budget = 1.0 / context().frontend_fps;
+    const auto cost = [&fs](const int skip) { return fs.emu_time + fs.draw_time / (skip + 1); };
+    const bool audio_low = fs.audio_active && (fs.audio_underrun || fs.audio_occupancy < 25);
+    const bool audio_ok = !fs.audio_active || fs.audio_occupancy >= 50;
+    const int skip = render.frameskip.max;
+
+    if (skip < max_auto_frameskip && (cost(skip) > budget * 0.95 || audio_low)) {
+        render.frameskip.max = skip + 1;
+        fs.settle = 10;
+    } else if (skip > 0 && audio_ok && cost(skip - 1) < budget * 0.8) {
+        render.frameskip.max = skip - 1;
+        fs.settle = 60;
+    }
+}
+
 static void check_variables()
 {
     using namespace retro;
@@ -706,7 +784,7 @@ static void check_variables()
         const bool old_timing = run_synced;
         run_synced = core_options[CORE_OPT_CORE_TIMING].toString() == "external";
 
-        if (dosbox_initialiazed && run_synced != old_timing) {
+        if (context().dosbox_initialiazed && run_synced != old_timing) {
             if (!run_synced) {
                 PIC_AddEvent(leave_thread, 1000.0f / internal_sync_fps);
             }
@@ -714,11 +792,33 @@ static void check_variables()
         }
     }
 
-    use_frame_duping = core_options[CORE_OPT_FRAME_DUPING].toBool();
-    use_spinlock = core_options[CORE_OPT_THREAD_SYNC].toString() == "spin";
-    useSpinlockThreadSync(use_spinlock);
+    context().use_frame_duping = core_options[CORE_OPT_FRAME_DUPING].toBool();
+
+    {
+        const bool old_auto_frameskip = context().use_auto_frameskip;
+        context().use_auto_frameskip = core_options[CORE_OPT_FRAMESKIP].toString() == "auto";
+
+        if (context().use_auto_frameskip != old_auto_frameskip) {
+            retro_audio_buffer_status_callback buffer_status{audio_buffer_status_cb};
+            environ_cb(
+                RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK,
+                context().use_auto_frameskip ? &buffer_status : nullptr);
+            context().auto_frameskip = {};
+            render.frameskip.timeDraw = false;
+            render.frameskip.drawTime = 0;
+            if (!context().use_auto_frameskip) {
+                // Back to the frameskip value of the [render] section.
+                auto* secprop =
+                    control ? static_cast<Section_prop*>(control->GetSection("render")) : nullptr;
+                render.frameskip.max = secprop ? secprop->Get_int("frameskip") : 0;
+                render.frameskip.count = 0;
+            }
+        }
+    }
+    context().use_spinlock = core_options[CORE_OPT_THREAD_SYNC].toString() == "spin";
+    useSpinlockThreadSync(context().use_spinlock);
 
-    if (!dosbox_initialiazed) {
+    if (!context().dosbox_initialiazed) {
         update_dosbox_variable(
             false, "dosbox", "memsize", core_options[CORE_OPT_MEMORY_SIZE].toString());
 
@@ -769,7 +869,7 @@ static void check_variables()
             false, "pci", "voodoomem", core_options[CORE_OPT_VOODOO_MEMORY_SIZE].toString());
 #endif
 
-        mount_overlay = core_options[CORE_OPT_SAVE_OVERLAY].toBool();
+        context().mount_overlay = core_options[CORE_OPT_SAVE_OVERLAY].toBool();
     } else {
         update_dosbox_variable(false, "dos", "xms", core_options[CORE_OPT_XMS].toString());
         update_dosbox_variable(false, "dos", "ems", core_options[CORE_OPT_EMS].toString());
@@ -788,12 +888,12 @@ static void check_variables()
         check_gus_variables(false);
 
         {
-            const bool prev_force_2axis_joystick = force_2axis_joystick;
+            const bool prev_force_2axis_joystick = context().force_2axis_joystick;
             const int prev_mouse_emu_deadzone = mouse_emu_deadzone;
 
-            force_2axis_joystick = core_options[CORE_OPT_JOYSTICK_FORCE_2AXIS].toBool();
+            context().force_2axis_joystick = core_options[CORE_OPT_JOYSTICK_FORCE_2AXIS].toBool();
             mouse_emu_deadzone = core_options[CORE_OPT_EMULATED_MOUSE_DEADZONE].toInt();
-            if (prev_force_2axis_joystick != force_2axis_joystick
+            if (prev_force_2axis_joystick != context().force_2axis_joystick
                 || prev_mouse_emu_deadzone != mouse_emu_deadzone)
             {
                 libretro_input_init();
@@ -891,14 +991,14 @@ static void start_dosbox(const std::string cmd_line)
     CommandLine com_line(cmd_line.empty() ? 1 : 2, argv);
     Config myconf(&com_line);
     control = &myconf;
-    dosbox_initialiazed = false;
+    context().dosbox_initialiazed = false;
 
     /* Init the configuration system and add default values */
     DOSBOX_Init();
 
     /* Load config */
-    if (!config_path.empty()) {
-        control->ParseConfigFile(from_u8string(config_path.u8string()).c_str());
+    if (!context().config_path.empty()) {
+        control->ParseConfigFile(from_u8string(context().config_path.u8string()).c_str());
     }
 
     check_variables();
@@ -907,7 +1007,7 @@ static void start_dosbox(const std::string cmd_line)
     /* Init done, go back to the main thread */
     switchThread();
 
-    dosbox_initialiazed = true;
+    context().dosbox_initialiazed = true;
     check_variables();
 
     if (!run_synced) {
@@ -1042,8 +1142,8 @@ void retro_init()
     {
         retro::logError("RETRO_ENVIRONMENT_GET_CONTENT_DIRECTORY failed.");
     } else if (content_dir) {
-        retro_content_directory = std::filesystem::path(content_dir).make_preferred();
-        retro::logDebug("Core assets directory: {}", retro_content_directory);
+        context().retro_content_directory = std::filesystem::path(content_dir).make_preferred();
+        retro::logDebug("Core assets directory: {}", context().retro_content_directory);
     }
 
 #ifdef HAVE_ALSA
@@ -1135,12 +1235,12 @@ void retro_init()
 void retro_deinit()
 {
     frontend_exit = true;
-    if (emu_thread.joinable()) {
+    if (context().emu_thread.joinable()) {
         if (!dosbox_exit) {
             switchThread();
         }
         try {
-            emu_thread.join();
+            context().emu_thread.join();
         }
         catch (...) {
         }
@@ -1152,9 +1252,19 @@ void retro_deinit()
 auto retro_load_game(const retro_game_info* const game) -> bool
 {
     gfx::pixel_format = RETRO_PIXEL_FORMAT_XRGB8888;
-    retro::logDebug("Setting pixel format to RETRO_PIXEL_FORMAT_XRGB8888.");
-    if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &gfx::pixel_format)) {
-        retro::logError("RETRO_ENVIRONMENT_SET_PIXEL_FORMAT failed.");
+    if (retro::core_options[CORE_OPT_PIXEL_FORMAT].toString() == "rgb565") {
+        gfx::pixel_format = RETRO_PIXEL_FORMAT_RGB565;
+        retro::logDebug("Setting pixel format to RETRO_PIXEL_FORMAT_RGB565.");
+        if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &gfx::pixel_format)) {
+            retro::logWarn("Frontend does not support RGB565, falling back to XRGB8888.");
+            gfx::pixel_format = RETRO_PIXEL_FORMAT_XRGB8888;
+        }
+    }
+    if (gfx::pixel_format == RETRO_PIXEL_FORMAT_XRGB8888) {
+        retro::logDebug("Setting pixel format to RETRO_PIXEL_FORMAT_XRGB8888.");
+        if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &gfx::pixel_format)) {
+            retro::logError("RETRO_ENVIRONMENT_SET_PIXEL_FORMAT failed.");
+        }
     }
 
     std::filesystem::path load_path;
@@ -1164,7 +1274,7 @@ auto retro_load_game(const retro_game_info* const game) -> bool
         try {
             load_path =
                 std::filesystem::canonical(std::filesystem::path(game->path)).make_preferred();
-            game_path = load_path;
+            context().game_path = load_path;
         }
         catch (const std::filesystem::filesystem_error& e) {
             retro::logError("Failed to load \"{}\": {}", game->path, e.what());
@@ -1173,25 +1283,26 @@ auto retro_load_game(const retro_game_info* const game) -> bool
     }
 
     if (const auto extension = lower_case(load_path.extension().string()); extension == ".conf") {
-        config_path = load_path;
+        context().config_path = load_path;
         load_path.clear();
     } else {
-        retro::logInfo("Loading default configuration: {}", config_path);
-        config_path = retro_save_directory / (retro_library_name + ".conf");
+        retro::logInfo("Loading default configuration: {}", context().config_path);
+        context().config_path = retro_save_directory / (retro_library_name + ".conf");
         if (extension == ".iso" || extension == ".cue") {
             disk_load_image = std::move(load_path);
             load_path.clear();
         }
     }
 
-    if (game_path.has_parent_path()) {
-        load_game_directory = game_path.parent_path();
+    if (context().game_path.has_parent_path()) {
+        load_game_directory = context().game_path.parent_path();
     }
 
-    emu_thread = std::thread(start_dosbox, from_u8string(load_path.u8string()));
+    context().emu_thread = std::thread(start_dosbox, from_u8string(load_path.u8string()));
     // Run dosbox until it sets its initial video mode.
     while (switchThread() != ThreadSwitchReason::VideoModeChange && !dosbox_exit)
         ;
+    context().frontend_fps = render.src.fps;
     update_mouse_speed_fix(gfx::height);
 
     if (!disk_load_image.empty()) {
@@ -1212,10 +1323,10 @@ auto retro_load_game_special(
 void retro_run()
 {
     if (dosbox_exit) {
-        if (emu_thread.joinable()) {
+        if (context().emu_thread.joinable()) {
             switchThread();
             try {
-                emu_thread.join();
+                context().emu_thread.join();
             }
             catch (...) {
             }
@@ -1227,12 +1338,31 @@ void retro_run()
     {
         bool new_fast_forward_status = false;
         environ_cb(RETRO_ENVIRONMENT_GET_FASTFORWARDING, &new_fast_forward_status);
-        if (new_fast_forward_status != fast_forward_status) {
+        if (new_fast_forward_status != context().fast_forward_status) {
             DOSBOX_UnlockSpeed(new_fast_forward_status);
-            fast_forward_status = new_fast_forward_status;
+            context().fast_forward_status = new_fast_forward_status;
         }
     }
 
+    /* Don't produce frames and audio the frontend is going to throw away. While fast-forwarding,
+     * frames are only drawn at about the rate the frontend can show them and synthesizers are
+     * muted, so nearly all the time goes to the emulated CPU. */
+    int av_enable = 3;
+    if (!environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable)) {
+        av_enable = 3;
+    }
+    const bool audio_enabled = av_enable & 2;
+    bool discard_frame = !(av_enable & 1);
+    if (!discard_frame && context().fast_forward_status) {
+        const auto now = std::chrono::steady_clock::now();
+        discard_frame = now - context().fast_forward_frame_time < std::chrono::milliseconds(16);
+        if (!discard_frame) {
+            context().fast_forward_frame_time = now;
+        }
+    }
+    RENDER_SetDiscard(discard_frame);
+    MIXER_RETRO_SkipSynthesis(!audio_enabled || context().fast_forward_status);
+
     if (retro::core_options.changed()) {
         const auto current_aspect_ratio = gfx::aspect_ratio;
         check_variables();
@@ -1244,30 +1374,55 @@ void retro_run()
     }
 
     /* Once C is mounted, mount the overlay */
-    if (Drives['C' - 'A'] && mount_overlay) {
+    if (Drives['C' - 'A'] && context().mount_overlay) {
         auto overlay_directory =
-            retro_save_directory / retro_library_name / game_path.parent_path().filename();
+            retro_save_directory / retro_library_name / context().game_path.parent_path().filename();
         mount_overlay_filesystem('C', std::move(overlay_directory));
-        mount_overlay = false;
+        context().mount_overlay = false;
     }
 
-    handle_libretro_input(enable_mouse_speed_clamp);
+    handle_libretro_input(context().enable_mouse_speed_clamp);
+
+    /* Frames can only go straight to the frontend when a whole frame is rendered within this
+     * call and an unchanged frame can be duped instead of uploaded from our own buffer. */
+    gfx::acquireFrontendFramebuffer(
+        run_synced && context().use_frame_duping && !retro_vkbd && !discard_frame);
 
     /* Run emulator */
-    auto current_gfx_fps = render.src.fps;
+    const bool frameskip_adapt =
+        context().use_auto_frameskip && run_synced && !context().fast_forward_status && !discard_frame;
+    render.frameskip.timeDraw = frameskip_adapt;
+    const auto frame_start = std::chrono::steady_clock::now();
     fakeTimingReset();
-    while (switchThread() == ThreadSwitchReason::VideoModeChange) {
-        update_gfx_mode(run_synced && render.src.fps != current_gfx_fps);
-        current_gfx_fps = render.src.fps;
+    switchThread();
+    if (frameskip_adapt) {
+        update_auto_frameskip(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - frame_start).count());
+    }
+
+    // All mode changes of this frame are renegotiated at once.
+    const bool fps_changed = run_synced && render.src.fps != context().frontend_fps;
+    if (gfx::geometry_changed || fps_changed) {
+        gfx::geometry_changed = false;
+        update_gfx_mode(fps_changed);
     }
 
-    /* Virtual keyboard */
-    if (retro_vkbd)
-        print_vkbd();
+    // The virtual keyboard is blended over a copy of the frame so the emulated screen is never
+    // drawn over and doesn't need to be rendered again.
+    const Bit8u* vkbd_frame = nullptr;
+    if (retro_vkbd) {
+        vkbd_frame = compose_vkbd(
+            run_synced ? gfx::framebuffers[0].data() : gfx::frontbuffer->data(),
+            !gfx::frontbuffer_uploaded || !context().use_frame_duping);
+    }
 
     // If we have a new frame, submit it.
-    if (gfx::frontbuffer_uploaded && use_frame_duping) {
+    if (vkbd_frame) {
+        video_cb(vkbd_frame, gfx::width, gfx::height, gfx::pitch);
+    } else if (gfx::frontbuffer_uploaded && context().use_frame_duping) {
         video_cb(nullptr, gfx::width, gfx::height, gfx::pitch);
+    } else if (gfx::direct_frame && gfx::direct_buffer) {
+        video_cb(gfx::direct_buffer, gfx::width, gfx::height, gfx::direct_pitch);
     } else if (run_synced) {
         video_cb(gfx::framebuffers[0].data(), gfx::width, gfx::height, gfx::pitch);
     } else {
@@ -1275,7 +1430,10 @@ void retro_run()
     }
     gfx::frontbuffer_uploaded = true;
 
-    upload_audio(queue_audio());
+    const auto audio_frames = queue_audio();
+    if (audio_enabled) {
+        upload_audio(audio_frames);
+    }
 
     if (use_retro_midi && have_retro_midi && retro_midi_interface.output_enabled()) {
         retro_midi_interface.flush();
@@ -1326,7 +1484,9 @@ void retro_cheat_set(unsigned /*unused*/, bool /*unused1*/, const char* /*unused
 { }
 
 void retro_unload_game()
-{ }
+{
+    disk_control::reset();
+}
 
 auto retro_get_region() -> unsigned
 {
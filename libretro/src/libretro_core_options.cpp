@@ -516,6 +516,18 @@ CoreOptions core_options {
             },
             false
         },
+        CoreOptionDefinition {
+            CORE_OPT_FRAMESKIP,
+            "Frameskip",
+            "When set to \"auto\", frames are skipped while the host can't draw every frame and "
+                "still keep up with the emulated CPU. Host frame times and the frontend's audio "
+                "buffer decide how many, up to 5 in a row. Only works with external timing.",
+            {
+                "off",
+                "auto",
+            },
+            "off"
+        },
         CoreOptionDefinition {
             CORE_OPT_THREAD_SYNC,
             "Thread synchronization method",
@@ -946,6 +958,19 @@ CoreOptions core_options {
             },
             "none"
         },
+        CoreOptionDefinition {
+            CORE_OPT_PIXEL_FORMAT,
+            "Output pixel format (restart)",
+            "The pixel format of the frames handed to the frontend. RGB565 halves the memory "
+                "bandwidth of every frame, which helps on low-end devices. Colors of 32-bit video "
+                "modes lose some precision. If the frontend does not support RGB565, XRGB8888 is "
+                "used instead.",
+            {
+                { "xrgb8888", "XRGB8888 (32-bit)" },
+                { "rgb565", "RGB565 (16-bit)" },
+            },
+            "xrgb8888"
+        },
     },
     CoreOptionCategory {
         CORE_OPTCAT_INPUT,
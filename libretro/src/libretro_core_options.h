@@ -20,6 +20,7 @@ inline constexpr const char* CORE_OPTCAT_TIMING = "timing";
 inline constexpr const char* CORE_OPT_CORE_TIMING = "core_timing";
 inline constexpr const char* CORE_OPT_CORE_VGA_REFRESH = "vga_hz";
 inline constexpr const char* CORE_OPT_FRAME_DUPING = "frame_duping";
+inline constexpr const char* CORE_OPT_FRAMESKIP = "frameskip";
 inline constexpr const char* CORE_OPT_THREAD_SYNC = "thread_sync";
 
 inline constexpr const char* CORE_OPTCAT_FILE_AND_DISK = "file_and_disk";
@@ -60,6 +61,7 @@ inline constexpr const char* CORE_OPT_CPU_CYCLES_DOWN = "cycledown";
 inline constexpr const char* CORE_OPTCAT_SCALING = "scaling";
 inline constexpr const char* CORE_OPT_ASPECT_CORRECTION = "aspect";
 inline constexpr const char* CORE_OPT_SCALER = "scaler";
+inline constexpr const char* CORE_OPT_PIXEL_FORMAT = "pixel_format";
 
 inline constexpr const char* CORE_OPTCAT_INPUT = "input";
 inline constexpr const char* CORE_OPT_JOYSTICK_FORCE_2AXIS = "joystick_force_2axis";
@@ -1,7 +1,6 @@
 #include "libretro_gfx.h"
 #include "dosbox.h"
 #include "emu_thread.h"
-#include "libretro-vkbd.h"
 #include "libretro.h"
 #include "libretro_dosbox.h"
 #include "log.h"
@@ -21,6 +20,14 @@ Bitu height;
 Bitu pitch;
 float aspect_ratio = 0;
 unsigned pixel_format = RETRO_PIXEL_FORMAT_0RGB1555;
+// Frontend memory for the current frame, only valid until the frame is submitted.
+Bit8u* direct_buffer = nullptr;
+Bitu direct_pitch;
+bool direct_frame = false;
+static bool last_frame_direct = false;
+bool geometry_changed = false;
+// Until the first mode is set, loading the game waits for it.
+static bool first_mode_set = false;
 static GFX_CallBack_t dosbox_cb = nullptr;
 #ifdef WITH_PINHACK
 bool request_VGA_SetupDrawing = false;
@@ -28,13 +35,24 @@ bool request_VGA_SetupDrawing = false;
 
 } // namespace gfx
 
+static auto bytes_per_pixel() -> Bitu
+{
+    return gfx::pixel_format == RETRO_PIXEL_FORMAT_RGB565 ? 2 : 4;
+}
+
 auto GFX_GetBestMode(const Bitu /*flags*/) -> Bitu
 {
+    if (gfx::pixel_format == RETRO_PIXEL_FORMAT_RGB565) {
+        return GFX_CAN_16 | GFX_RGBONLY;
+    }
     return GFX_CAN_32 | GFX_RGBONLY;
 }
 
 auto GFX_GetRGB(const Bit8u red, const Bit8u green, const Bit8u blue) -> Bitu
 {
+    if (gfx::pixel_format == RETRO_PIXEL_FORMAT_RGB565) {
+        return ((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3);
+    }
     return (red << 16) | (green << 8) | (blue << 0);
 }
 
@@ -42,12 +60,12 @@ auto GFX_SetSize(
     const Bitu width, const Bitu height, const Bitu /*flags*/, const double scalex,
     const double scaley, const GFX_CallBack_t cb) -> Bitu
 {
-    for (auto& buf : gfx::framebuffers) {
-        std::fill(buf.begin(), buf.end(), 0);
-    }
+    const bool size_changed =
+        width != gfx::width || height != gfx::height || width * bytes_per_pixel() != gfx::pitch;
     gfx::width = width;
     gfx::height = height;
-    gfx::pitch = width * 4;
+    gfx::direct_buffer = nullptr;
+    gfx::pitch = width * bytes_per_pixel();
     gfx::aspect_ratio = (width * scalex) / (height * scaley);
     gfx::dosbox_cb = cb;
 
@@ -55,19 +73,39 @@ auto GFX_SetSize(
         return 0;
     }
 
-    const auto fb_size = gfx::width * gfx::height * 4;
+    const auto fb_size = gfx::pitch * gfx::height;
     if (fb_size > gfx::framebuffers[0].size()) {
         retro::logDebug("Increasing max framebuffer size to {}x{}", gfx::width, gfx::height);
         for (auto& buf : gfx::framebuffers) {
             buf.resize(fb_size);
         }
     }
-    switchThread(ThreadSwitchReason::VideoModeChange);
+    // Only the part the new mode uses can show up before the next full frame is drawn.
+    if (size_changed) {
+        for (auto& buf : gfx::framebuffers) {
+            std::fill(buf.begin(), buf.begin() + fb_size, 0);
+        }
+    }
+
+    // Mode changes are passed on to the frontend once per frame by retro_run, so programs that
+    // switch modes or reprogram the CRTC over and over don't stall on the frontend each time.
+    if (!gfx::first_mode_set) {
+        gfx::first_mode_set = true;
+        switchThread(ThreadSwitchReason::VideoModeChange);
+    } else {
+        gfx::geometry_changed = true;
+    }
     return GFX_GetBestMode(0);
 }
 
 auto GFX_StartUpdate(Bit8u*& pixels, Bitu& pitch) -> bool
 {
+    if (gfx::direct_buffer) {
+        pixels = gfx::direct_buffer;
+        pitch = gfx::direct_pitch;
+        gfx::direct_frame = true;
+        return true;
+    }
     pixels = run_synced ? gfx::framebuffers[0].data() : gfx::backbuffer->data();
     pitch = gfx::pitch;
     return true;
@@ -75,16 +113,6 @@ auto GFX_StartUpdate(Bit8u*& pixels, Bitu& pitch) -> bool
 
 void GFX_EndUpdate(const Bit16u* const changedLines)
 {
-    if (retro_vkbd) {
-        gfx::frontbuffer_uploaded = false;
-        gfx::dosbox_cb(GFX_CallBackRedraw);
-
-        if (!run_synced) {
-            std::swap(gfx::frontbuffer, gfx::backbuffer);
-        }
-        return;
-    }
-
 #ifdef WITH_PINHACK
     if (gfx::request_VGA_SetupDrawing) {
         gfx::request_VGA_SetupDrawing = false;
@@ -102,6 +130,31 @@ void GFX_EndUpdate(const Bit16u* const changedLines)
     }
 }
 
+void gfx::acquireFrontendFramebuffer(const bool allowed)
+{
+    direct_buffer = nullptr;
+    direct_frame = false;
+
+    retro_framebuffer fb{};
+    fb.width = width;
+    fb.height = height;
+    fb.access_flags = RETRO_MEMORY_ACCESS_WRITE;
+    if (allowed && dosbox_cb && environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb)
+        && fb.data && fb.format == pixel_format && fb.width == width && fb.height == height
+        && fb.pitch >= pitch)
+    {
+        direct_buffer = static_cast<Bit8u*>(fb.data);
+        direct_pitch = fb.pitch;
+    }
+
+    // Frontend memory does not hold the previous frame, and our own buffer misses the frames
+    // that went to the frontend. Either way, only changed lines would not be enough.
+    if ((direct_buffer || last_frame_direct) && dosbox_cb) {
+        dosbox_cb(GFX_CallBackRedraw);
+    }
+    last_frame_direct = direct_buffer != nullptr;
+}
+
 // Stubs
 void GFX_SetTitle(Bit32s /*cycles*/, int /*frameskip*/, bool /*paused*/)
 { }
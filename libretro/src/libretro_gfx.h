@@ -17,10 +17,18 @@ extern Bitu height;
 extern Bitu pitch;
 extern float aspect_ratio;
 extern unsigned pixel_format;
+extern Bit8u* direct_buffer;
+extern Bitu direct_pitch;
+extern bool direct_frame;
+// The output size changed and the frontend wasn't told yet.
+extern bool geometry_changed;
 #ifdef WITH_PINHACK
 extern bool request_VGA_SetupDrawing;
 #endif
 
+/* Try to render the next frame straight into the frontend's framebuffer. */
+void acquireFrontendFramebuffer(bool allowed);
+
 } // namespace gfx
 
 /*
@@ -143,6 +143,7 @@ auto MidiHandlerBassmidi::Open(const char* const /*conf*/) -> bool
     }
 
     MixerChannel_ptr_t channel(MIXER_AddChannel(mixerCallback, 44100, "BASSMID"), MIXER_DelChannel);
+    channel->synthesized = true;
     channel->Enable(true);
     channel_ = std::move(channel);
     is_open_ = true;
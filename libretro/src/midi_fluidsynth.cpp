@@ -5,10 +5,118 @@
 #include "libretro_dosbox.h"
 #include "log.h"
 #include "setup.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <string_view>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 MidiHandlerFluidsynth MidiHandlerFluidsynth::instance_;
 
+#ifndef _WIN32
+namespace {
+
+/* Soundfont file callbacks backed by a read-only shared mapping. Sample data is
+ * copied straight out of the page cache, which all processes mapping the same
+ * soundfont share, instead of going through stdio buffers.
+ */
+struct MappedSoundfont final
+{
+    const char* data;
+    fluid_long_long_t size;
+    fluid_long_long_t pos;
+};
+
+auto mappedOpen(const char* const filename) -> void*
+{
+    const int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    // Start readahead of the whole file in the background so that samples
+    // loaded later on program changes don't have to wait for the disk.
+    madvise(data, st.st_size, MADV_WILLNEED);
+    return new MappedSoundfont{static_cast<const char*>(data), st.st_size, 0};
+}
+
+auto mappedRead(void* const buf, const fluid_long_long_t count, void* const handle) -> int
+{
+    auto* file = static_cast<MappedSoundfont*>(handle);
+    if (count < 0 || count > file->size - file->pos) {
+        return FLUID_FAILED;
+    }
+    memcpy(buf, file->data + file->pos, count);
+    file->pos += count;
+    return FLUID_OK;
+}
+
+auto mappedSeek(void* const handle, const fluid_long_long_t offset, const int origin) -> int
+{
+    auto* file = static_cast<MappedSoundfont*>(handle);
+    fluid_long_long_t pos;
+    switch (origin) {
+    case SEEK_SET:
+        pos = offset;
+        break;
+    case SEEK_CUR:
+        pos = file->pos + offset;
+        break;
+    case SEEK_END:
+        pos = file->size + offset;
+        break;
+    default:
+        return FLUID_FAILED;
+    }
+    if (pos < 0 || pos > file->size) {
+        return FLUID_FAILED;
+    }
+    file->pos = pos;
+    return FLUID_OK;
+}
+
+auto mappedTell(void* const handle) -> fluid_long_long_t
+{
+    return static_cast<MappedSoundfont*>(handle)->pos;
+}
+
+auto mappedClose(void* const handle) -> int
+{
+    auto* file = static_cast<MappedSoundfont*>(handle);
+    munmap(const_cast<char*>(file->data), file->size);
+    delete file;
+    return FLUID_OK;
+}
+
+// Resident set size in MB, or -1 if the host doesn't tell.
+auto residentMegabytes() -> long
+{
+    std::ifstream statm("/proc/self/statm");
+    long total;
+    long resident;
+    if (!(statm >> total >> resident)) {
+        return -1;
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024) / 1024;
+}
+
+} // namespace
+#endif
+
 void init_fluid_dosbox_settings(Section_prop& secprop)
 {
     auto* str_prop = secprop.Add_string("fluid.soundfont", Property::Changeable::WhenIdle, "");
@@ -97,19 +205,46 @@ auto MidiHandlerFluidsynth::Open(const char* const /*conf*/) -> bool
     fluid_settings_setnum(settings.get(), "synth.chorus.speed", get_double("fluid.chorus.speed"));
     fluid_settings_setnum(settings.get(), "synth.chorus.depth", get_double("fluid.chorus.depth"));
 
+    // Only load the samples of presets that are actually selected. Older
+    // fluidsynth versions don't know this setting and load everything.
+    fluid_settings_setint(settings.get(), "synth.dynamic-sample-loading", 1);
+
     fsynth_ptr_t synth(new_fluid_synth(settings.get()), delete_fluid_synth);
     if (!synth) {
         retro::logError("Error creating fluidsynth synthesiser.");
         return false;
     }
 
+#ifndef _WIN32
+    if (fluid_sfloader_t* loader = new_fluid_defsfloader(settings.get()); loader) {
+        fluid_sfloader_set_callbacks(
+            loader, mappedOpen, mappedRead, mappedSeek, mappedTell, mappedClose);
+        // Tried before the stock loader, which still handles anything this one fails to open.
+        fluid_synth_add_sfloader(synth.get(), loader);
+    }
+#endif
+
     if (std::string_view soundfont = section->Get_string("fluid.soundfont"); !soundfont.empty()) {
         if (fluid_synth_sfcount(synth.get()) > 0) {
             retro::logDebug("Fluidsynth soundfont already loaded. Not loading another one.");
         } else {
             retro::logDebug("Loading fluidsynth soundfont: {}.", soundfont);
+#ifndef _WIN32
+            const long rss_before = residentMegabytes();
+#endif
+            const auto start = std::chrono::steady_clock::now();
             if (fluid_synth_sfload(synth.get(), soundfont.data(), true) == FLUID_FAILED) {
                 retro::logError("Failed to load fluidsynth soundfont.");
+            } else {
+                const auto msecs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+#ifndef _WIN32
+                retro::logInfo(
+                    "Fluidsynth soundfont loaded in {} ms, resident memory {} MB -> {} MB.",
+                    msecs.count(), rss_before, residentMegabytes());
+#else
+                retro::logInfo("Fluidsynth soundfont loaded in {} ms.", msecs.count());
+#endif
             }
         }
     }
@@ -117,6 +252,7 @@ auto MidiHandlerFluidsynth::Open(const char* const /*conf*/) -> bool
     MixerChannel_ptr_t channel(
         MIXER_AddChannel(mixerCallback, section->Get_int("fluid.samplerate"), "FSYNTH"),
         MIXER_DelChannel);
+    channel->synthesized = true;
     channel->Enable(true);
 
     settings_ = std::move(settings);
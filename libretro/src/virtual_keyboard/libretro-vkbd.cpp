@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <string.h>
+#include <vector>
 
 #include "keyboard.h"
 #include "libretro-graph.h"
@@ -529,6 +530,193 @@ void print_vkbd(void)
 #endif
 }
 
+/* The keyboard only changes with its own state, so it is rendered once into a cached layer and
+ * blended over each frame. Drawing it over black gives the premultiplied color of every pixel
+ * and drawing it over white gives the amount of background that shows through. */
+typedef struct
+{
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   bool page;
+   bool transparent;
+   bool capslock;
+   unsigned theme;
+   int alpha;
+   int pos_x;
+   int pos_y;
+   int pressed;
+   int sticky1;
+   int sticky2;
+   int flags[10];
+#ifdef POINTER_DEBUG
+   int pointer_x;
+   int pointer_y;
+#endif
+} vkbd_layer_state_t;
+
+static vkbd_layer_state_t vkbd_layer_state;
+static bool vkbd_layer_valid = false;
+static std::vector<Bit8u> vkbd_layer_color;
+static std::vector<Bit8u> vkbd_layer_trans;
+static std::vector<Bit8u> vkbd_layer_output;
+static unsigned vkbd_layer_top = 0;
+static unsigned vkbd_layer_bottom = 0;
+
+static void get_vkbd_layer_state(vkbd_layer_state_t *state)
+{
+   memset(state, 0, sizeof(*state));
+   state->width       = gfx::width;
+   state->height      = gfx::height;
+   state->pitch       = gfx::pitch;
+   state->page        = retro_vkbd_page;
+   state->transparent = retro_vkbd_transparent;
+   state->capslock    = retro_capslock;
+   state->theme       = opt_vkbd_theme;
+   state->alpha       = opt_vkbd_alpha;
+   state->pos_x       = vkey_pos_x;
+   state->pos_y       = vkey_pos_y;
+   state->pressed     = vkey_pressed;
+   state->sticky1     = vkey_sticky1;
+   state->sticky2     = vkey_sticky2;
+   memcpy(state->flags, vkflag, sizeof(state->flags));
+#ifdef POINTER_DEBUG
+   state->pointer_x   = pointer_x;
+   state->pointer_y   = pointer_y;
+#endif
+}
+
+static void build_vkbd_layer(void)
+{
+   size_t size                       = gfx::pitch * gfx::height;
+   std::vector<Bit8u> *frontbuffer   = gfx::frontbuffer;
+   std::vector<Bit8u> white(size, 0xff);
+   unsigned y;
+   size_t i;
+
+   vkbd_layer_color.assign(size, 0);
+   vkbd_layer_trans.resize(size);
+
+   gfx::frontbuffer = &vkbd_layer_color;
+   print_vkbd();
+   gfx::frontbuffer = &white;
+   print_vkbd();
+   gfx::frontbuffer = frontbuffer;
+
+   if (gfx::pitch / gfx::width == 4)
+   {
+      for (i = 0; i < size; i++)
+         vkbd_layer_trans[i] = white[i] - vkbd_layer_color[i];
+   }
+   else
+   {
+      const uint16_t *color = (const uint16_t*)vkbd_layer_color.data();
+      const uint16_t *over  = (const uint16_t*)white.data();
+      uint16_t *trans       = (uint16_t*)vkbd_layer_trans.data();
+
+      for (i = 0; i < size / 2; i++)
+         trans[i] = (((over[i] & 0xf800) - (color[i] & 0xf800)) & 0xf800)
+                  | (((over[i] & 0x07e0) - (color[i] & 0x07e0)) & 0x07e0)
+                  | (((over[i] & 0x001f) - (color[i] & 0x001f)) & 0x001f);
+   }
+
+   /* Rows the keyboard leaves alone are copied straight through */
+   vkbd_layer_top    = gfx::height;
+   vkbd_layer_bottom = 0;
+   for (y = 0; y < gfx::height; y++)
+   {
+      const Bit8u *color = vkbd_layer_color.data() + y * gfx::pitch;
+      const Bit8u *over  = white.data() + y * gfx::pitch;
+
+      for (i = 0; i < gfx::pitch; i++)
+      {
+         if (color[i] != 0 || over[i] != 0xff)
+         {
+            if (vkbd_layer_top > y)
+               vkbd_layer_top = y;
+            vkbd_layer_bottom = y + 1;
+            break;
+         }
+      }
+   }
+}
+
+static void blend_vkbd_row32(Bit8u *out, const Bit8u *frame, const Bit8u *color,
+      const Bit8u *trans, unsigned bytes)
+{
+   unsigned i;
+
+   /* Plain byte loop so the compiler can vectorize it */
+   for (i = 0; i < bytes; i++)
+   {
+      unsigned value = color[i] + ((trans[i] * frame[i] + 255) >> 8);
+      out[i] = (value > 255) ? 255 : value;
+   }
+}
+
+static void blend_vkbd_row16(Bit8u *out, const Bit8u *frame, const Bit8u *color,
+      const Bit8u *trans, unsigned bytes)
+{
+   uint16_t *dst       = (uint16_t*)out;
+   const uint16_t *src = (const uint16_t*)frame;
+   const uint16_t *col = (const uint16_t*)color;
+   const uint16_t *tr  = (const uint16_t*)trans;
+   unsigned i;
+
+   /* (p + (p >> 5) + 1) >> 5 equals p / 31 for every product of two 5 bit
+    * channels plus rounding, likewise for 6 bits and 63. Shifts instead of
+    * divisions let the compiler vectorize the loop like the 32 bit one. */
+   for (i = 0; i < bytes / 2; i++)
+   {
+      unsigned r = ((tr[i] >> 11)       ) * ((src[i] >> 11)       ) + 15;
+      unsigned g = ((tr[i] >>  5) & 0x3f) * ((src[i] >>  5) & 0x3f) + 31;
+      unsigned b = ((tr[i]      ) & 0x1f) * ((src[i]      ) & 0x1f) + 15;
+
+      r = ((col[i] >> 11)       ) + ((r + (r >> 5) + 1) >> 5);
+      g = ((col[i] >>  5) & 0x3f) + ((g + (g >> 6) + 1) >> 6);
+      b = ((col[i]      ) & 0x1f) + ((b + (b >> 5) + 1) >> 5);
+
+      dst[i] = ((r > 0x1f) ? 0x1f : r) << 11 | ((g > 0x3f) ? 0x3f : g) << 5 | ((b > 0x1f) ? 0x1f : b);
+   }
+}
+
+const uint8_t *compose_vkbd(const uint8_t *frame, bool frame_changed)
+{
+   vkbd_layer_state_t state;
+   size_t size      = gfx::pitch * gfx::height;
+   unsigned y;
+
+   get_vkbd_layer_state(&state);
+   if (!vkbd_layer_valid || memcmp(&state, &vkbd_layer_state, sizeof(state)) != 0)
+   {
+      build_vkbd_layer();
+      vkbd_layer_state = state;
+      vkbd_layer_valid = true;
+   }
+   else if (!frame_changed)
+      return NULL;
+
+   vkbd_layer_output.resize(size);
+   Bit8u *out = vkbd_layer_output.data();
+
+   memcpy(out, frame, vkbd_layer_top * gfx::pitch);
+   for (y = vkbd_layer_top; y < vkbd_layer_bottom; y++)
+   {
+      size_t offset = y * gfx::pitch;
+
+      if (gfx::pitch / gfx::width == 4)
+         blend_vkbd_row32(out + offset, frame + offset, vkbd_layer_color.data() + offset,
+               vkbd_layer_trans.data() + offset, gfx::pitch);
+      else
+         blend_vkbd_row16(out + offset, frame + offset, vkbd_layer_color.data() + offset,
+               vkbd_layer_trans.data() + offset, gfx::pitch);
+   }
+   memcpy(out + vkbd_layer_bottom * gfx::pitch, frame + vkbd_layer_bottom * gfx::pitch,
+         size - vkbd_layer_bottom * gfx::pitch);
+
+   return out;
+}
+
 static void input_vkbd_sticky(void)
 {
    if (vkey_sticky && last_vkey_pressed != -1 && last_vkey_pressed > 0)
@@ -573,13 +761,14 @@ void toggle_vkbd(void)
       return;
 
    retro_vkbd = !retro_vkbd;
+   vkbd_layer_valid = false;
 
    /* Reset VKBD input readiness */
    retro_vkbd_ready = -2;
 
-   /* Force update, otherwise internal timing mode will
+   /* Resubmit the current frame, otherwise internal timing mode will
     * not update screen unless emulated screen updates */
-   GFX_EndUpdate(0);
+   gfx::frontbuffer_uploaded = false;
 }
 
 void input_vkbd(void)
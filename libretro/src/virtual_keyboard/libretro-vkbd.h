@@ -9,6 +9,7 @@ extern bool retro_vkbd;
 extern bool retro_capslock;
 
 extern void print_vkbd(void);
+extern const uint8_t *compose_vkbd(const uint8_t *frame, bool frame_changed);
 extern void input_vkbd(void);
 extern void toggle_vkbd(void);
 
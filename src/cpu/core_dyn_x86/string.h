@@ -31,6 +31,25 @@ enum STRING_OP {
 	STR_CMPSB=24,STR_CMPSW,STR_CMPSD
 };
 
+/* rep movs and rep stos done in bulk, returns the count that is left when the cycles ran out */
+static Bit32u dyn_helper_string(Bit32u info,PhysPt si_base,PhysPt di_base) {
+	Bitu mask=(info & 0x100) ? 0xffffffff : 0xffff;
+	Bitu size=(Bitu)1 << (info & 3);
+	Bitu count=reg_ecx & mask;
+	Bitu todo=count;
+	Bitu limit=(CPU_Cycles>0) ? (Bitu)CPU_Cycles : 1;
+	if (todo>limit) todo=limit;
+	count-=todo;CPU_Cycles-=(Bits)todo;
+	Bitu si_index=reg_esi & mask;
+	Bitu di_index=reg_edi & mask;
+	if ((info & 0xff)<STR_STOSB) PAGING_StringMove(di_base,di_index,si_base,si_index,todo,size,cpu.direction,mask);
+	else PAGING_StringStore(di_base,di_index,reg_eax,todo,size,cpu.direction,mask);
+	reg_esi=(Bit32u)((reg_esi & ~mask) | si_index);
+	reg_edi=(Bit32u)((reg_edi & ~mask) | di_index);
+	reg_ecx=(Bit32u)((reg_ecx & ~mask) | count);
+	return (Bit32u)count;
+}
+
 static void dyn_string(STRING_OP op) {
 	DynReg * si_base=decode.segprefix ? decode.segprefix : DREG(DS);
 	DynReg * di_base=DREG(ES);
@@ -40,6 +59,26 @@ static void dyn_string(STRING_OP op) {
 		gen_dop_word_imm(DOP_SUB,true,DREG(CYCLES),decode.cycles);
 		gen_releasereg(DREG(CYCLES));
 		decode.cycles=0;
+		switch (op) {
+		case STR_MOVSB:	case STR_MOVSW:	case STR_MOVSD:
+		case STR_STOSB:	case STR_STOSW:	case STR_STOSD:
+			/* The helper works on the registers in memory */
+			gen_releasereg(DREG(ESI));gen_releasereg(DREG(EDI));
+			gen_releasereg(DREG(ECX));gen_releasereg(DREG(EAX));
+			gen_call_function((void*)&dyn_helper_string,"%Id%Drd%Drd%Rd",
+				op | (decode.big_addr ? 0x100 : 0),si_base,di_base,DREG(TMPW));
+			gen_dop_word(DOP_TEST,true,DREG(TMPW),DREG(TMPW));
+			gen_releasereg(DREG(TMPW));
+			/* Restart the instruction when the cycles ran out */
+			dyn_savestate(&save_info[used_save_info].state);
+			save_info[used_save_info].branch_pos=gen_create_branch_long(BR_NZ);
+			save_info[used_save_info].eip_change=decode.op_start-decode.code_start;
+			save_info[used_save_info].type=normal;
+			used_save_info++;
+			return;
+		default:
+			break;
+		}
 	}
 	/* Check what each string operation will be using */
 	switch (op) {
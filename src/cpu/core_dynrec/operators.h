@@ -1650,11 +1650,9 @@ static Bit16u DRC_CALL_CONV dynrec_movsb_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		mem_writeb(di_base+reg_di,mem_readb(si_base+reg_si));
-		reg_si+=add_index;
-		reg_di+=add_index;
-	}
+	Bitu si_index=reg_si,di_index=reg_di,todo=count;
+	PAGING_StringMove(di_base,di_index,si_base,si_index,todo,1,add_index,0xffff);
+	reg_si=(Bit16u)si_index;reg_di=(Bit16u)di_index;
 	return count_left;
 }
 
@@ -1668,11 +1666,9 @@ static Bit32u DRC_CALL_CONV dynrec_movsb_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		mem_writeb(di_base+reg_edi,mem_readb(si_base+reg_esi));
-		reg_esi+=add_index;
-		reg_edi+=add_index;
-	}
+	Bitu si_index=reg_esi,di_index=reg_edi,todo=count;
+	PAGING_StringMove(di_base,di_index,si_base,si_index,todo,1,add_index,0xffffffff);
+	reg_esi=si_index;reg_edi=di_index;
 	return count_left;
 }
 
@@ -1686,12 +1682,9 @@ static Bit16u DRC_CALL_CONV dynrec_movsw_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=1;
-	for (;count>0;count--) {
-		mem_writew(di_base+reg_di,mem_readw(si_base+reg_si));
-		reg_si+=add_index;
-		reg_di+=add_index;
-	}
+	Bitu si_index=reg_si,di_index=reg_di,todo=count;
+	PAGING_StringMove(di_base,di_index,si_base,si_index,todo,2,add_index,0xffff);
+	reg_si=(Bit16u)si_index;reg_di=(Bit16u)di_index;
 	return count_left;
 }
 
@@ -1705,12 +1698,9 @@ static Bit32u DRC_CALL_CONV dynrec_movsw_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=1;
-	for (;count>0;count--) {
-		mem_writew(di_base+reg_edi,mem_readw(si_base+reg_esi));
-		reg_esi+=add_index;
-		reg_edi+=add_index;
-	}
+	Bitu si_index=reg_esi,di_index=reg_edi,todo=count;
+	PAGING_StringMove(di_base,di_index,si_base,si_index,todo,2,add_index,0xffffffff);
+	reg_esi=si_index;reg_edi=di_index;
 	return count_left;
 }
 
@@ -1724,12 +1714,9 @@ static Bit16u DRC_CALL_CONV dynrec_movsd_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=2;
-	for (;count>0;count--) {
-		mem_writed(di_base+reg_di,mem_readd(si_base+reg_si));
-		reg_si+=add_index;
-		reg_di+=add_index;
-	}
+	Bitu si_index=reg_si,di_index=reg_di,todo=count;
+	PAGING_StringMove(di_base,di_index,si_base,si_index,todo,4,add_index,0xffff);
+	reg_si=(Bit16u)si_index;reg_di=(Bit16u)di_index;
 	return count_left;
 }
 
@@ -1743,12 +1730,9 @@ static Bit32u DRC_CALL_CONV dynrec_movsd_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=2;
-	for (;count>0;count--) {
-		mem_writed(di_base+reg_edi,mem_readd(si_base+reg_esi));
-		reg_esi+=add_index;
-		reg_edi+=add_index;
-	}
+	Bitu si_index=reg_esi,di_index=reg_edi,todo=count;
+	PAGING_StringMove(di_base,di_index,si_base,si_index,todo,4,add_index,0xffffffff);
+	reg_esi=si_index;reg_edi=di_index;
 	return count_left;
 }
 
@@ -1763,10 +1747,9 @@ static Bit16u DRC_CALL_CONV dynrec_lodsb_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		reg_al=mem_readb(si_base+reg_si);
-		reg_si+=add_index;
-	}
+	Bitu si_index=reg_si,todo=count;
+	reg_al=(Bit8u)PAGING_StringLoad(si_base,si_index,reg_al,todo,1,add_index,0xffff);
+	reg_si=(Bit16u)si_index;
 	return count_left;
 }
 
@@ -1780,10 +1763,9 @@ static Bit32u DRC_CALL_CONV dynrec_lodsb_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		reg_al=mem_readb(si_base+reg_esi);
-		reg_esi+=add_index;
-	}
+	Bitu si_index=reg_esi,todo=count;
+	reg_al=(Bit8u)PAGING_StringLoad(si_base,si_index,reg_al,todo,1,add_index,0xffffffff);
+	reg_esi=si_index;
 	return count_left;
 }
 
@@ -1797,11 +1779,9 @@ static Bit16u DRC_CALL_CONV dynrec_lodsw_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=1;
-	for (;count>0;count--) {
-		reg_ax=mem_readw(si_base+reg_si);
-		reg_si+=add_index;
-	}
+	Bitu si_index=reg_si,todo=count;
+	reg_ax=(Bit16u)PAGING_StringLoad(si_base,si_index,reg_ax,todo,2,add_index,0xffff);
+	reg_si=(Bit16u)si_index;
 	return count_left;
 }
 
@@ -1815,11 +1795,9 @@ static Bit32u DRC_CALL_CONV dynrec_lodsw_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=1;
-	for (;count>0;count--) {
-		reg_ax=mem_readw(si_base+reg_esi);
-		reg_esi+=add_index;
-	}
+	Bitu si_index=reg_esi,todo=count;
+	reg_ax=(Bit16u)PAGING_StringLoad(si_base,si_index,reg_ax,todo,2,add_index,0xffffffff);
+	reg_esi=si_index;
 	return count_left;
 }
 
@@ -1833,11 +1811,9 @@ static Bit16u DRC_CALL_CONV dynrec_lodsd_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=2;
-	for (;count>0;count--) {
-		reg_eax=mem_readd(si_base+reg_si);
-		reg_si+=add_index;
-	}
+	Bitu si_index=reg_si,todo=count;
+	reg_eax=PAGING_StringLoad(si_base,si_index,reg_eax,todo,4,add_index,0xffff);
+	reg_si=(Bit16u)si_index;
 	return count_left;
 }
 
@@ -1851,11 +1827,9 @@ static Bit32u DRC_CALL_CONV dynrec_lodsd_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=2;
-	for (;count>0;count--) {
-		reg_eax=mem_readd(si_base+reg_esi);
-		reg_esi+=add_index;
-	}
+	Bitu si_index=reg_esi,todo=count;
+	reg_eax=PAGING_StringLoad(si_base,si_index,reg_eax,todo,4,add_index,0xffffffff);
+	reg_esi=si_index;
 	return count_left;
 }
 
@@ -1870,10 +1844,9 @@ static Bit16u DRC_CALL_CONV dynrec_stosb_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		mem_writeb(di_base+reg_di,reg_al);
-		reg_di+=add_index;
-	}
+	Bitu di_index=reg_di,todo=count;
+	PAGING_StringStore(di_base,di_index,reg_al,todo,1,add_index,0xffff);
+	reg_di=(Bit16u)di_index;
 	return count_left;
 }
 
@@ -1887,10 +1860,9 @@ static Bit32u DRC_CALL_CONV dynrec_stosb_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		mem_writeb(di_base+reg_edi,reg_al);
-		reg_edi+=add_index;
-	}
+	Bitu di_index=reg_edi,todo=count;
+	PAGING_StringStore(di_base,di_index,reg_al,todo,1,add_index,0xffffffff);
+	reg_edi=di_index;
 	return count_left;
 }
 
@@ -1904,11 +1876,9 @@ static Bit16u DRC_CALL_CONV dynrec_stosw_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=1;
-	for (;count>0;count--) {
-		mem_writew(di_base+reg_di,reg_ax);
-		reg_di+=add_index;
-	}
+	Bitu di_index=reg_di,todo=count;
+	PAGING_StringStore(di_base,di_index,reg_ax,todo,2,add_index,0xffff);
+	reg_di=(Bit16u)di_index;
 	return count_left;
 }
 
@@ -1922,11 +1892,9 @@ static Bit32u DRC_CALL_CONV dynrec_stosw_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=1;
-	for (;count>0;count--) {
-		mem_writew(di_base+reg_edi,reg_ax);
-		reg_edi+=add_index;
-	}
+	Bitu di_index=reg_edi,todo=count;
+	PAGING_StringStore(di_base,di_index,reg_ax,todo,2,add_index,0xffffffff);
+	reg_edi=di_index;
 	return count_left;
 }
 
@@ -1940,11 +1908,9 @@ static Bit16u DRC_CALL_CONV dynrec_stosd_word(Bit16u count,Bit16s add_index,Phys
 		count=(Bit16u)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=2;
-	for (;count>0;count--) {
-		mem_writed(di_base+reg_di,reg_eax);
-		reg_di+=add_index;
-	}
+	Bitu di_index=reg_di,todo=count;
+	PAGING_StringStore(di_base,di_index,reg_eax,todo,4,add_index,0xffff);
+	reg_di=(Bit16u)di_index;
 	return count_left;
 }
 
@@ -1958,11 +1924,9 @@ static Bit32u DRC_CALL_CONV dynrec_stosd_dword(Bit32u count,Bit32s add_index,Phy
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	add_index<<=2;
-	for (;count>0;count--) {
-		mem_writed(di_base+reg_edi,reg_eax);
-		reg_edi+=add_index;
-	}
+	Bitu di_index=reg_edi,todo=count;
+	PAGING_StringStore(di_base,di_index,reg_eax,todo,4,add_index,0xffffffff);
+	reg_edi=di_index;
 	return count_left;
 }
 
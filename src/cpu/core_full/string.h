@@ -96,143 +96,71 @@
 		}
 		break;
 	case R_STOSB:
-		for (;count>0;count--) {
-			SaveMb(di_base+di_index,reg_al);
-			di_index=(di_index+add_index) & add_mask;
-		}
+		PAGING_StringStore(di_base,di_index,reg_al,count,1,add_index,add_mask);
 		break;
 	case R_STOSW:
-		add_index<<=1;
-		for (;count>0;count--) {
-			SaveMw(di_base+di_index,reg_ax);
-			di_index=(di_index+add_index) & add_mask;
-		}
+		PAGING_StringStore(di_base,di_index,reg_ax,count,2,add_index,add_mask);
 		break;
 	case R_STOSD:
-		add_index<<=2;
-		for (;count>0;count--) {
-			SaveMd(di_base+di_index,reg_eax);
-			di_index=(di_index+add_index) & add_mask;
-		}
+		PAGING_StringStore(di_base,di_index,reg_eax,count,4,add_index,add_mask);
 		break;
 	case R_MOVSB:
-		for (;count>0;count--) {
-			SaveMb(di_base+di_index,LoadMb(si_base+si_index));
-			di_index=(di_index+add_index) & add_mask;
-			si_index=(si_index+add_index) & add_mask;
-		}
+		PAGING_StringMove(di_base,di_index,si_base,si_index,count,1,add_index,add_mask);
 		break;
 	case R_MOVSW:
-		add_index<<=1;
-		for (;count>0;count--) {
-			SaveMw(di_base+di_index,LoadMw(si_base+si_index));
-			di_index=(di_index+add_index) & add_mask;
-			si_index=(si_index+add_index) & add_mask;
-		}
+		PAGING_StringMove(di_base,di_index,si_base,si_index,count,2,add_index,add_mask);
 		break;
 	case R_MOVSD:
-		add_index<<=2;
-		for (;count>0;count--) {
-			SaveMd(di_base+di_index,LoadMd(si_base+si_index));
-			di_index=(di_index+add_index) & add_mask;
-			si_index=(si_index+add_index) & add_mask;
-		}
+		PAGING_StringMove(di_base,di_index,si_base,si_index,count,4,add_index,add_mask);
 		break;
 	case R_LODSB:
-		for (;count>0;count--) {
-			reg_al=LoadMb(si_base+si_index);
-			si_index=(si_index+add_index) & add_mask;
-		}
+		reg_al=(Bit8u)PAGING_StringLoad(si_base,si_index,reg_al,count,1,add_index,add_mask);
 		break;
 	case R_LODSW:
-		add_index<<=1;
-		for (;count>0;count--) {
-			reg_ax=LoadMw(si_base+si_index);
-			si_index=(si_index+add_index) & add_mask;
-		}
+		reg_ax=(Bit16u)PAGING_StringLoad(si_base,si_index,reg_ax,count,2,add_index,add_mask);
 		break;
 	case R_LODSD:
-		add_index<<=2;
-		for (;count>0;count--) {
-			reg_eax=LoadMd(si_base+si_index);
-			si_index=(si_index+add_index) & add_mask;
-		}
+		reg_eax=PAGING_StringLoad(si_base,si_index,reg_eax,count,4,add_index,add_mask);
 		break;
 	case R_SCASB:
 		{
-			Bit8u val2;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val2=LoadMb(di_base+di_index);
-				di_index=(di_index+add_index) & add_mask;
-				if ((reg_al==val2)!=inst.repz) break;
-			}
-			CMPB(reg_al,val2,LoadD,0);
+			Bit32u val2;
+			CPU_Cycles-=PAGING_StringScan(di_base,di_index,reg_al,inst.repz,val2,count,1,add_index,add_mask);
+			CMPB(reg_al,(Bit8u)val2,LoadD,0);
 		}
 		break;
 	case R_SCASW:
 		{
-			add_index<<=1;Bit16u val2;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val2=LoadMw(di_base+di_index);
-				di_index=(di_index+add_index) & add_mask;
-				if ((reg_ax==val2)!=inst.repz) break;
-			}
-			CMPW(reg_ax,val2,LoadD,0);
+			Bit32u val2;
+			CPU_Cycles-=PAGING_StringScan(di_base,di_index,reg_ax,inst.repz,val2,count,2,add_index,add_mask);
+			CMPW(reg_ax,(Bit16u)val2,LoadD,0);
 		}
 		break;
 	case R_SCASD:
 		{
-			add_index<<=2;Bit32u val2;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val2=LoadMd(di_base+di_index);
-				di_index=(di_index+add_index) & add_mask;
-				if ((reg_eax==val2)!=inst.repz) break;
-			}
+			Bit32u val2;
+			CPU_Cycles-=PAGING_StringScan(di_base,di_index,reg_eax,inst.repz,val2,count,4,add_index,add_mask);
 			CMPD(reg_eax,val2,LoadD,0);
 		}
 		break;
 	case R_CMPSB:
 		{
-			Bit8u val1,val2;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val1=LoadMb(si_base+si_index);
-				val2=LoadMb(di_base+di_index);
-				si_index=(si_index+add_index) & add_mask;
-				di_index=(di_index+add_index) & add_mask;
-				if ((val1==val2)!=inst.repz) break;
-			}
-			CMPB(val1,val2,LoadD,0);
+			Bit32u val1,val2;
+			CPU_Cycles-=PAGING_StringCompare(di_base,di_index,si_base,si_index,inst.repz,val1,val2,count,1,add_index,add_mask);
+			CMPB((Bit8u)val1,(Bit8u)val2,LoadD,0);
 		}
 		break;
 	case R_CMPSW:
 		{
-			add_index<<=1;Bit16u val1,val2;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val1=LoadMw(si_base+si_index);
-				val2=LoadMw(di_base+di_index);
-				si_index=(si_index+add_index) & add_mask;
-				di_index=(di_index+add_index) & add_mask;
-				if ((val1==val2)!=inst.repz) break;
-			}
-			CMPW(val1,val2,LoadD,0);
+			Bit32u val1,val2;
+			CPU_Cycles-=PAGING_StringCompare(di_base,di_index,si_base,si_index,inst.repz,val1,val2,count,2,add_index,add_mask);
+			CMPW((Bit16u)val1,(Bit16u)val2,LoadD,0);
 		}
 		break;
 	case R_CMPSD:
 		{
-			add_index<<=2;Bit32u val1,val2;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val1=LoadMd(si_base+si_index);
-				val2=LoadMd(di_base+di_index);
-				si_index=(si_index+add_index) & add_mask;
-				di_index=(di_index+add_index) & add_mask;
-				if ((val1==val2)!=inst.repz) break;
-			}
+			Bit32u val1,val2;
+			CPU_Cycles-=PAGING_StringCompare(di_base,di_index,si_base,si_index,inst.repz,val1,val2,count,4,add_index,add_mask);
 			CMPD(val1,val2,LoadD,0);
 		}
 		break;
@@ -138,6 +138,9 @@ static INLINE Bit32u Fetchd() {
 
 #define EALookupTable (core.ea_table)
 
+/* Set while CPU_Core_Normal_Nested_Run steps a single instruction */
+static bool nested_step=false;
+
 Bits CPU_Core_Normal_Run(void) {
 	while (CPU_Cycles-->0) {
 		LOADIP;
@@ -178,9 +181,11 @@ restart_opcode:
 			}
 #endif
 			CPU_Exception(6,0);
+			if (GCC_UNLIKELY(nested_step)) break;
 			continue;
 		}
 		SAVEIP;
+		if (GCC_UNLIKELY(nested_step)) break;
 	}
 	FillFlags();
 	return CBRET_NONE;
@@ -204,6 +209,19 @@ Bits CPU_Core_Normal_Trap_Run(void) {
 }
 
 
+/* Run a single instruction from inside an interrupted instruction of this core,
+   like the page fault handler does, the decoder state of that instruction is
+   kept. The cycle budget stays visible so the instruction can end the slice. */
+Bits CPU_Core_Normal_Nested_Run(void) {
+	Bit8u old_core[sizeof(core)];
+	memcpy(old_core,&core,sizeof(core));
+	bool old_step=nested_step;
+	nested_step=true;
+	Bits ret=CPU_Core_Normal_Run();
+	nested_step=old_step;
+	memcpy(&core,old_core,sizeof(core));
+	return ret;
+}
 
 void CPU_Core_Normal_Init(void) {
 
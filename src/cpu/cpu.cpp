@@ -20,6 +20,10 @@
 #include <assert.h>
 #include <sstream>
 #include <stddef.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "dosbox.h"
 #include "cpu.h"
 #include "memory.h"
@@ -30,6 +34,7 @@
 #include "paging.h"
 #include "lazyflags.h"
 #include "support.h"
+#include "pic.h"
 
 #ifdef __LIBRETRO__
 #include "libretro_dosbox.h"
@@ -313,6 +318,7 @@ public:
 	}
 	bool SetSelector(Bitu new_sel) {
 		valid=false;
+		CPU_TableCachesInvalidate();
 		if ((new_sel & 0xfffc)==0) {
 			selector=0;
 			base=0;
@@ -526,10 +532,279 @@ doconforming:
 	return true;
 }
 
+/* Fault statistics, counted per report interval when enabled with faultstats */
+static struct {
+	bool enabled;
+	Bitu interval;
+	std::string file;
+	Bit32u exceptions[256];
+	Bit32u v86_ints[256];
+	std::unordered_map<Bit64u,Bit32u> sites;
+	std::unordered_map<Bit64u,Bit32u> pages;
+	std::unordered_map<Bit64u,Bit32u> ports;
+} faultstats;
+
+static void CPU_FaultStatsInterrupt(Bitu num,Bitu type,Bitu oldeip) {
+	if (type & CPU_INT_EXCEPTION) {
+		faultstats.exceptions[num&0xff]++;
+		faultstats.sites[((Bit64u)SegValue(cs) << 32) | (Bit32u)oldeip]++;
+		if (num==EXCEPTION_PF) faultstats.pages[paging.cr2 >> 12]++;
+	} else if ((type & CPU_INT_SOFTWARE) && (reg_flags & FLAG_VM)) {
+		faultstats.v86_ints[num&0xff]++;
+	}
+}
+
+static void CPU_FaultStatsTop(std::vector<std::string> & lines,const char * title,
+		const std::unordered_map<Bit64u,Bit32u> & counts,const char * format,bool seg_off) {
+	if (counts.empty()) return;
+	std::vector<std::pair<Bit32u,Bit64u> > sorted;
+	sorted.reserve(counts.size());
+	for (std::unordered_map<Bit64u,Bit32u>::const_iterator it=counts.begin();it!=counts.end();++it)
+		sorted.push_back(std::make_pair(it->second,it->first));
+	size_t top=std::min<size_t>(sorted.size(),10);
+	std::partial_sort(sorted.begin(),sorted.begin()+top,sorted.end(),
+		std::greater<std::pair<Bit32u,Bit64u> >());
+	lines.push_back(title);
+	char name[32],line[64];
+	for (size_t i=0;i<top;i++) {
+		Bit64u key=sorted[i].second;
+		if (seg_off) snprintf(name,sizeof(name),format,(Bit32u)(key >> 32),(Bit32u)key);
+		else snprintf(name,sizeof(name),format,(Bit32u)key);
+		snprintf(line,sizeof(line),"  %-16s %u",name,sorted[i].first);
+		lines.push_back(line);
+	}
+}
+
+static void CPU_FaultStatsReport(void) {
+	std::vector<std::string> lines;
+	char line[64];
+	for (Bitu i=0;i<256;i++) {
+		if (!faultstats.exceptions[i]) continue;
+		if (lines.empty()) lines.push_back("Exceptions by vector:");
+		snprintf(line,sizeof(line),"  %02X               %u",(unsigned)i,faultstats.exceptions[i]);
+		lines.push_back(line);
+	}
+	CPU_FaultStatsTop(lines,"Exceptions by CS:EIP:",faultstats.sites,"%04X:%08X",true);
+	CPU_FaultStatsTop(lines,"Page faults by linear page:",faultstats.pages,"%05X000",false);
+	CPU_FaultStatsTop(lines,"I/O faults by port:",faultstats.ports,"%04X",false);
+	bool v86_ints=false;
+	for (Bitu i=0;i<256;i++) {
+		if (!faultstats.v86_ints[i]) continue;
+		if (!v86_ints) lines.push_back("V86 software interrupts:");
+		v86_ints=true;
+		snprintf(line,sizeof(line),"  INT %02X           %u",(unsigned)i,faultstats.v86_ints[i]);
+		lines.push_back(line);
+	}
+	memset(faultstats.exceptions,0,sizeof(faultstats.exceptions));
+	memset(faultstats.v86_ints,0,sizeof(faultstats.v86_ints));
+	faultstats.sites.clear();
+	faultstats.pages.clear();
+	faultstats.ports.clear();
+	if (lines.empty()) return;
+
+	FILE * f=faultstats.file.empty() ? 0 : fopen(faultstats.file.c_str(),"a");
+	if (f) {
+		fprintf(f,"Fault statistics at %u ms\n",(unsigned)PIC_Ticks);
+		for (size_t i=0;i<lines.size();i++) fprintf(f,"%s\n",lines[i].c_str());
+		fclose(f);
+	} else {
+		LOG_MSG("CPU: Fault statistics at %u ms",(unsigned)PIC_Ticks);
+		for (size_t i=0;i<lines.size();i++) LOG_MSG("%s",lines[i].c_str());
+	}
+}
+
+static void CPU_FaultStatsEvent(Bitu /*val*/) {
+	CPU_FaultStatsReport();
+	PIC_AddEvent(CPU_FaultStatsEvent,(float)faultstats.interval*1000.0f);
+}
+
+/* Host side copies of guest tables. The RAM pages they were read from get a
+   handler that drops all copies on the first guest write to them; loading new
+   tables or a new TSS and flushing the TLB drop them as well. */
+#define WATCH_PAGES 16
+
+static struct {
+	PageHandler * ram;
+	Bitu pages;
+	Bitu lin_page[WATCH_PAGES];
+	Bitu phys_page[WATCH_PAGES];
+} watch;
+
+class WatchPageHandler : public PageHandler {
+public:
+	WatchPageHandler() {
+		flags=PFLAG_READABLE;
+	}
+	Bitu readb(PhysPt addr) {
+		return host_readb(get_tlb_read(addr)+addr);
+	}
+	Bitu readw(PhysPt addr) {
+		return host_readw(get_tlb_read(addr)+addr);
+	}
+	Bitu readd(PhysPt addr) {
+		return host_readd(get_tlb_read(addr)+addr);
+	}
+	void writeb(PhysPt addr,Bitu val) {
+		host_writeb(Written(addr),val);
+	}
+	void writew(PhysPt addr,Bitu val) {
+		host_writew(Written(addr),val);
+	}
+	void writed(PhysPt addr,Bitu val) {
+		host_writed(Written(addr),val);
+	}
+	HostPt GetHostReadPt(Bitu phys_page) {
+		// a dynamic core code page wrapped this one and writes past it
+		if (MEM_GetPageHandler(phys_page)!=this) CPU_TableCachesInvalidate();
+		return watch.ram->GetHostReadPt(phys_page);
+	}
+private:
+	/* Drop the table copies. The page goes back to RAM even when it is no longer
+	   watched, as when a dynamic core code page released it to this handler. */
+	HostPt Written(PhysPt addr) {
+		HostPt host=get_tlb_read(addr)+addr;
+		CPU_TableCachesInvalidate();
+		Bitu phys_page=(Bitu)(host-MemBase) >> 12;
+		if (MEM_GetPageHandler(phys_page)==this) {
+			MEM_SetPageHandler(phys_page,1,watch.ram);
+			PAGING_UnlinkPages(addr >> 12,1);
+		}
+		return host;
+	}
+};
+
+static WatchPageHandler watch_handler;
+
+/* Watch a linear page, returns its host memory or 0 if it is not plain RAM.
+   Like the dynamic cores, only this linear page gets relinked. */
+static HostPt CPU_WatchPage(Bitu lin_page) {
+	Bitu phys_page=lin_page;
+	if (!PAGING_MakePhysPage(phys_page) || phys_page>=MEM_TotalPages()) return 0;
+	PageHandler * handler=MEM_GetPageHandler(phys_page);
+	if (handler!=&watch_handler) {
+		if (handler->flags!=(PFLAG_READABLE|PFLAG_WRITEABLE)) return 0;
+		if (watch.pages==WATCH_PAGES) return 0;
+		watch.ram=handler;
+		watch.lin_page[watch.pages]=lin_page;
+		watch.phys_page[watch.pages]=phys_page;
+		watch.pages++;
+		MEM_SetPageHandler(phys_page,1,&watch_handler);
+		PAGING_UnlinkPages(lin_page,1);
+	}
+	return watch.ram->GetHostReadPt(phys_page);
+}
+
+static bool CPU_WatchRange(PhysPt lin_addr,Bit8u * dest,Bitu len) {
+	while (len) {
+		HostPt host=CPU_WatchPage(lin_addr >> 12);
+		if (!host) return false;
+		Bitu ofs=lin_addr & 4095;
+		Bitu chunk=std::min<Bitu>(len,4096-ofs);
+		if (dest) {
+			memcpy(dest,host+ofs,chunk);
+			dest+=chunk;
+		}
+		lin_addr+=chunk;
+		len-=chunk;
+	}
+	return true;
+}
+
+/* I/O permission bitmap of the current TSS, taken the first time a port check
+   needs it */
+enum { IOMAP_EMPTY,IOMAP_FAILED,IOMAP_VALID };
+
+static struct {
+	Bitu state;
+	bool deny;				// map offset beyond the TSS limit
+	Bitu size;				// bitmap bytes mirrored in bits
+	Bit8u bits[8192+2];
+} iomap;
+
+/* Gate and target code segment descriptors of each interrupt vector, valid
+   while their generation matches */
+static struct {
+	Bitu gen;
+	struct {
+		Bitu gate_gen;
+		Bitu cs_gen;
+		Bitu cs_sel;
+		Descriptor gate;
+		Descriptor cs_desc;
+	} vec[256];
+} intcache = { 1, {} };
+
+void CPU_TableCachesInvalidate(void) {
+	iomap.state=IOMAP_EMPTY;
+	intcache.gen++;
+	for (Bitu i=0;i<watch.pages;i++) {
+		if (MEM_GetPageHandler(watch.phys_page[i])==&watch_handler) {
+			MEM_SetPageHandler(watch.phys_page[i],1,watch.ram);
+			// writes find the RAM handler again instead of the one in the tlb
+			PAGING_UnlinkPages(watch.lin_page[i],1);
+		}
+	}
+	watch.pages=0;
+}
+
+static void CPU_IOMapBuild(void) {
+	iomap.state=IOMAP_FAILED;
+	Bit8u word[2];
+	if (!CPU_WatchRange(cpu_tss.base+0x66,word,2)) return;
+	Bitu ofs=word[0] | (word[1] << 8);
+	iomap.deny=ofs>cpu_tss.limit;
+	iomap.size=0;
+	if (!iomap.deny) {
+		iomap.size=std::min<Bitu>(cpu_tss.limit-ofs+1,sizeof(iomap.bits));
+		if (!CPU_WatchRange(cpu_tss.base+ofs,iomap.bits,iomap.size)) return;
+	}
+	iomap.state=IOMAP_VALID;
+}
+
+static bool CPU_GetIntGate(Bitu num,Descriptor & gate) {
+	if (intcache.vec[num].gate_gen==intcache.gen) {
+		gate=intcache.vec[num].gate;
+		return true;
+	}
+	if (!cpu.idt.GetDescriptor(num<<3,gate)) return false;
+	if (CPU_WatchRange(cpu.idt.GetBase()+(num<<3),0,8)) {
+		intcache.vec[num].gate=gate;
+		intcache.vec[num].gate_gen=intcache.gen;
+	}
+	return true;
+}
+
+static bool CPU_GetIntCodeDescriptor(Bitu num,Bitu selector,Descriptor & desc) {
+	if (intcache.vec[num].cs_gen==intcache.gen && intcache.vec[num].cs_sel==selector) {
+		desc=intcache.vec[num].cs_desc;
+		return true;
+	}
+	if (!cpu.gdt.GetDescriptor(selector,desc)) return false;
+	PhysPt where=((selector & 4) ? cpu.gdt.GetLDTBase() : cpu.gdt.GetBase())+(selector & ~7);
+	if (CPU_WatchRange(where,0,8)) {
+		intcache.vec[num].cs_desc=desc;
+		intcache.vec[num].cs_sel=selector;
+		intcache.vec[num].cs_gen=intcache.gen;
+	}
+	return true;
+}
+
 bool CPU_IO_Exception(Bitu port,Bitu size) {
 	if (cpu.pmode && ((GETFLAG_IOPL<cpu.cpl) || GETFLAG(VM))) {
 		cpu.mpl=0;
 		if (!cpu_tss.is386) goto doexception;
+		if (GCC_UNLIKELY(iomap.state==IOMAP_EMPTY)) CPU_IOMapBuild();
+		if (GCC_LIKELY(iomap.state==IOMAP_VALID)) {
+			if (iomap.deny) goto doexception;
+			Bitu index=port/8;
+			if (GCC_LIKELY(index+1<iomap.size)) {
+				Bitu map=iomap.bits[index] | (iomap.bits[index+1] << 8);
+				Bitu mask=(0xffff>>(16-size)) << (port&7);
+				if (map & mask) goto doexception;
+				cpu.mpl=3;
+				return false;
+			}
+		}
 		PhysPt bwhere=cpu_tss.base+0x66;
 		Bitu ofs=mem_readw(bwhere);
 		if (ofs>cpu_tss.limit) goto doexception;
@@ -543,6 +818,7 @@ bool CPU_IO_Exception(Bitu port,Bitu size) {
 doexception:
 	cpu.mpl=3;
 	LOG(LOG_CPU,LOG_NORMAL)("IO Exception port %X",port);
+	if (GCC_UNLIKELY(faultstats.enabled)) faultstats.ports[port]++;
 	return CPU_PrepareException(EXCEPTION_GP,0);
 }
 
@@ -565,6 +841,7 @@ void CPU_Interrupt(Bitu num,Bitu type,Bitu oldeip) {
 	}
 	lastint=num;
 	FillFlags();
+	if (GCC_UNLIKELY(faultstats.enabled)) CPU_FaultStatsInterrupt(num,type,oldeip);
 #if C_DEBUG
 	switch (num) {
 	case 0xcd:
@@ -606,7 +883,7 @@ void CPU_Interrupt(Bitu num,Bitu type,Bitu oldeip) {
 		} 
 
 		Descriptor gate;
-		if (!cpu.idt.GetDescriptor(num<<3,gate)) {
+		if (!CPU_GetIntGate(num,gate)) {
 			// zone66
 			CPU_Exception(EXCEPTION_GP,num*8+2+((type&CPU_INT_SOFTWARE)?0:1));
 			return;
@@ -633,7 +910,7 @@ void CPU_Interrupt(Bitu num,Bitu type,Bitu oldeip) {
 				CPU_CHECK_COND((gate_sel & 0xfffc)==0,
 					"INT:Gate with CS zero selector",
 					EXCEPTION_GP,(type&CPU_INT_SOFTWARE)?0:1)
-				CPU_CHECK_COND(!cpu.gdt.GetDescriptor(gate_sel,cs_desc),
+				CPU_CHECK_COND(!CPU_GetIntCodeDescriptor(num,gate_sel,cs_desc),
 					"INT:Gate with CS beyond limit",
 					EXCEPTION_GP,(gate_sel & 0xfffc)+((type&CPU_INT_SOFTWARE)?0:1))
 
@@ -1496,6 +1773,7 @@ Bitu CPU_SLDT(void) {
 }
 
 bool CPU_LLDT(Bitu selector) {
+	CPU_TableCachesInvalidate();
 	if (!cpu.gdt.LLDT(selector)) {
 		LOG(LOG_CPU,LOG_ERROR)("LLDT failed, selector=%X",selector);
 		return true;
@@ -1539,12 +1817,14 @@ void CPU_LGDT(Bitu limit,Bitu base) {
 	LOG(LOG_CPU,LOG_NORMAL)("GDT Set to base:%X limit:%X",base,limit);
 	cpu.gdt.SetLimit(limit);
 	cpu.gdt.SetBase(base);
+	CPU_TableCachesInvalidate();
 }
 
 void CPU_LIDT(Bitu limit,Bitu base) {
 	LOG(LOG_CPU,LOG_NORMAL)("IDT Set to base:%X limit:%X",base,limit);
 	cpu.idt.SetLimit(limit);
 	cpu.idt.SetBase(base);
+	CPU_TableCachesInvalidate();
 }
 
 Bitu CPU_SGDT_base(void) {
@@ -2341,6 +2621,12 @@ public:
 
 		CPU_CycleUp=section->Get_int("cycleup");
 		CPU_CycleDown=section->Get_int("cycledown");
+
+		PIC_RemoveEvents(CPU_FaultStatsEvent);
+		faultstats.interval=section->Get_int("faultstats");
+		faultstats.file=section->Get_string("faultstatsfile");
+		faultstats.enabled=(faultstats.interval>0);
+		if (faultstats.enabled) PIC_AddEvent(CPU_FaultStatsEvent,(float)faultstats.interval*1000.0f);
 		std::string core(section->Get_string("core"));
 		cpudecoder=&CPU_Core_Normal_Run;
 		if (core == "normal") {
@@ -2432,6 +2718,7 @@ public:
 static CPU * test;
 
 void CPU_ShutDown(Section* sec) {
+	if (faultstats.enabled) CPU_FaultStatsReport();
 #if (C_DYNAMIC_X86)
 	CPU_Core_Dyn_X86_Cache_Close();
 #elif (C_DYNREC)
@@ -28,100 +28,144 @@
 
 LazyFlags lflags;
 
+/* Width of the lazy result, selects the masks used for ZF, SF and the
+   specialized conditions. FS_FLAGS reads the real flags, FS_ZERO always
+   yields false and FS_BAD marks types that never end up in lflags. */
+enum {
+	FS_FLAGS=0,FS_ZERO,FS_B,FS_W,FS_D,FS_BAD
+};
+
+static const Bit32u size_mask[FS_BAD+1]={ 0,0,0xff,0xffff,0xffffffff,0 };
+static const Bit32u sign_mask[FS_BAD+1]={ 0,0,0x80,0x8000,0x80000000,0 };
+
+#define FMASK_LAZY (FLAG_CF|FLAG_PF|FLAG_AF|FLAG_ZF|FLAG_SF|FLAG_OF)
+
+typedef Bit32u (*LazyFlagGetter)(void);
+
+/* Everything needed to evaluate one lazy flag type. The flags in fill are
+   written by FillFlags, all others keep their current value. The
+   condition getters are optional shortcuts for the compound jumps. */
+struct LazyFlagType {
+	Bitu size;
+	Bitu fill;
+	LazyFlagGetter cf,af,of;
+	LazyFlagGetter be,l,le;
+};
+
+static Bit32u flag_false(void)	{ return 0; }
+static Bit32u cf_flag(void)		{ return GETFLAG(CF); }
+static Bit32u af_flag(void)		{ return GETFLAG(AF); }
+static Bit32u of_flag(void)		{ return GETFLAG(OF); }
+
+static Bit32u cf_bad(void) {
+	LOG(LOG_CPU,LOG_ERROR)("get_CF Unknown %" sBitfs(d),lflags.type);
+	return 0;
+}
+static Bit32u af_bad(void) {
+	LOG(LOG_CPU,LOG_ERROR)("get_AF Unknown %" sBitfs(d),lflags.type);
+	return 0;
+}
+static Bit32u of_bad(void) {
+	LOG(LOG_CPU,LOG_ERROR)("get_OF Unkown %" sBitfs(d),lflags.type);
+	return 0;
+}
+
+/* AF only looks at the low nibble, so one version serves all widths */
+static Bit32u af_ARITH(void)	{ return ((lf_var1b ^ lf_var2b) ^ lf_resb) & 0x10; }
+static Bit32u af_INC(void)		{ return (lf_resb & 0x0f) == 0; }
+static Bit32u af_DEC(void)		{ return (lf_resb & 0x0f) == 0x0f; }
+static Bit32u af_NEG(void)		{ return (lf_resb & 0x0f) != 0; }
+static Bit32u af_SHIFT(void)	{ return lf_var2b & 0x1f; }
+
+#define LAZY_GETTERS(W,STYPE,MSB,MAX)																\
+static Bit32u cf_ADD##W(void)	{ return (lf_res##W<lf_var1##W); }								\
+static Bit32u cf_ADC##W(void)	{ return (lf_res##W < lf_var1##W) || (lflags.oldcf && (lf_res##W == lf_var1##W)); } \
+static Bit32u cf_SBB##W(void)	{ return (lf_var1##W < lf_res##W) || (lflags.oldcf && (lf_var2##W==MAX)); } \
+static Bit32u cf_SUB##W(void)	{ return (lf_var1##W<lf_var2##W); }								\
+static Bit32u cf_SHR##W(void)	{ return (lf_var1##W >> (lf_var2b - 1)) & 1; }					\
+static Bit32u cf_SAR##W(void)	{ return (((STYPE) lf_var1##W) >> (lf_var2b - 1)) & 1; }		\
+static Bit32u cf_NEG##W(void)	{ return lf_var1##W; }											\
+static Bit32u of_ADD##W(void)	{ return ((lf_var1##W ^ lf_var2##W ^ MSB) & (lf_res##W ^ lf_var2##W)) & MSB; } \
+static Bit32u of_SUB##W(void)	{ return ((lf_var1##W ^ lf_var2##W) & (lf_var1##W ^ lf_res##W)) & MSB; } \
+static Bit32u of_INC##W(void)	{ return (lf_res##W == MSB); }									\
+static Bit32u of_DEC##W(void)	{ return (lf_res##W == MSB-1); }								\
+static Bit32u of_NEG##W(void)	{ return (lf_var1##W == MSB); }									\
+static Bit32u of_SHL##W(void)	{ return (lf_res##W ^ lf_var1##W) & MSB; }						\
+static Bit32u of_SHR##W(void) {																	\
+	if ((lf_var2b&0x1f)==1) return (lf_var1##W >= MSB);											\
+	else return false;																			\
+}																								\
+/* after SUB/CMP the conditions are plain comparisons of the operands */						\
+static Bit32u be_SUB##W(void)	{ return lf_var1##W <= lf_var2##W; }							\
+static Bit32u l_SUB##W(void)	{ return (STYPE)lf_var1##W < (STYPE)lf_var2##W; }				\
+static Bit32u le_SUB##W(void)	{ return (STYPE)lf_var1##W <= (STYPE)lf_var2##W; }				\
+/* logical operations clear CF and OF */														\
+static Bit32u be_LOG##W(void)	{ return lf_res##W == 0; }										\
+static Bit32u l_LOG##W(void)	{ return lf_res##W & MSB; }										\
+static Bit32u le_LOG##W(void)	{ return (lf_res##W == 0) || (lf_res##W & MSB); }
+
+LAZY_GETTERS(b,Bit8s,0x80,0xff)
+LAZY_GETTERS(w,Bit16s,0x8000,0xffff)
+LAZY_GETTERS(d,Bit32s,0x80000000,0xffffffff)
+
+static Bit32u cf_SHLb(void) {
+	if (lf_var2b>8) return false;
+	else return (lf_var1b >> (8-lf_var2b)) & 1;
+}
+static Bit32u cf_SHLw(void) {
+	if (lf_var2b>16) return false;
+	else return (lf_var1w >> (16-lf_var2b)) & 1;
+}
+static Bit32u cf_SHLd(void) {
+	/* Also used for DSHLw, not correct for shifts higher than 16 */
+	return (lf_var1d >> (32 - lf_var2b)) & 1;
+}
+
+#define LAZY_ARITH(SIZE,CF,OF)		{ SIZE,FMASK_LAZY,CF,af_ARITH,OF,0,0,0 }
+#define LAZY_SUB(SIZE,W)			{ SIZE,FMASK_LAZY,cf_SUB##W,af_ARITH,of_SUB##W,be_SUB##W,l_SUB##W,le_SUB##W }
+#define LAZY_LOGIC(SIZE,W)			{ SIZE,FMASK_LAZY,flag_false,flag_false,flag_false,be_LOG##W,l_LOG##W,le_LOG##W }
+#define LAZY_SHIFT(SIZE,CF,OF)		{ SIZE,FMASK_LAZY,CF,af_SHIFT,OF,0,0,0 }
+#define LAZY_INCDEC(SIZE,AF,OF)		{ SIZE,FMASK_LAZY & ~FLAG_CF,cf_flag,AF,OF,0,0,0 }
+#define LAZY_DSHIFT(SIZE,CF,OF)		{ SIZE,FMASK_LAZY & ~FLAG_AF,CF,flag_false,OF,0,0,0 }
+#define LAZY_BAD(CF)				{ FS_BAD,0,CF,af_bad,of_bad,0,0,0 }
+
+/* Indexed by lflags.type, has to follow the order of the t_* enum */
+static const LazyFlagType lazy_types[t_LASTFLAG]={
+	{ FS_FLAGS,0,cf_flag,af_flag,of_flag,0,0,0 },				/* t_UNKNOWN */
+	LAZY_ARITH(FS_B,cf_ADDb,of_ADDb),LAZY_ARITH(FS_W,cf_ADDw,of_ADDw),LAZY_ARITH(FS_D,cf_ADDd,of_ADDd),
+	LAZY_LOGIC(FS_B,b),LAZY_LOGIC(FS_W,w),LAZY_LOGIC(FS_D,d),	/* OR */
+	LAZY_ARITH(FS_B,cf_ADCb,of_ADDb),LAZY_ARITH(FS_W,cf_ADCw,of_ADDw),LAZY_ARITH(FS_D,cf_ADCd,of_ADDd),
+	LAZY_ARITH(FS_B,cf_SBBb,of_SUBb),LAZY_ARITH(FS_W,cf_SBBw,of_SUBw),LAZY_ARITH(FS_D,cf_SBBd,of_SUBd),
+	LAZY_LOGIC(FS_B,b),LAZY_LOGIC(FS_W,w),LAZY_LOGIC(FS_D,d),	/* AND */
+	LAZY_SUB(FS_B,b),LAZY_SUB(FS_W,w),LAZY_SUB(FS_D,d),
+	LAZY_LOGIC(FS_B,b),LAZY_LOGIC(FS_W,w),LAZY_LOGIC(FS_D,d),	/* XOR */
+	LAZY_SUB(FS_B,b),LAZY_SUB(FS_W,w),LAZY_SUB(FS_D,d),			/* CMP */
+	LAZY_INCDEC(FS_B,af_INC,of_INCb),LAZY_INCDEC(FS_W,af_INC,of_INCw),LAZY_INCDEC(FS_D,af_INC,of_INCd),
+	LAZY_INCDEC(FS_B,af_DEC,of_DECb),LAZY_INCDEC(FS_W,af_DEC,of_DECw),LAZY_INCDEC(FS_D,af_DEC,of_DECd),
+	LAZY_LOGIC(FS_B,b),LAZY_LOGIC(FS_W,w),LAZY_LOGIC(FS_D,d),	/* TEST */
+	LAZY_SHIFT(FS_B,cf_SHLb,of_SHLb),LAZY_SHIFT(FS_W,cf_SHLw,of_SHLw),LAZY_SHIFT(FS_D,cf_SHLd,of_SHLd),
+	LAZY_SHIFT(FS_B,cf_SHRb,of_SHRb),LAZY_SHIFT(FS_W,cf_SHRw,of_SHRw),LAZY_SHIFT(FS_D,cf_SHRd,of_SHRd),
+	LAZY_SHIFT(FS_B,cf_SARb,flag_false),LAZY_SHIFT(FS_W,cf_SARw,flag_false),LAZY_SHIFT(FS_D,cf_SARd,flag_false),
+	LAZY_BAD(cf_bad),LAZY_BAD(cf_bad),LAZY_BAD(cf_bad),			/* ROL */
+	LAZY_BAD(cf_bad),LAZY_BAD(cf_bad),LAZY_BAD(cf_bad),			/* ROR */
+	LAZY_BAD(cf_bad),LAZY_BAD(cf_bad),LAZY_BAD(cf_bad),			/* RCL */
+	LAZY_BAD(cf_SHRb),LAZY_BAD(cf_SHRw),LAZY_BAD(cf_SHRd),		/* RCR */
+	{ FS_B,FMASK_LAZY,cf_NEGb,af_NEG,of_NEGb,0,0,0 },
+	{ FS_W,FMASK_LAZY,cf_NEGw,af_NEG,of_NEGw,0,0,0 },
+	{ FS_D,FMASK_LAZY,cf_NEGd,af_NEG,of_NEGd,0,0,0 },
+	LAZY_DSHIFT(FS_W,cf_SHLd,of_SHLw),LAZY_DSHIFT(FS_D,cf_SHLd,of_SHLd),
+	/* DSHRw is not correct for shifts higher than 16 */
+	LAZY_DSHIFT(FS_W,cf_SHRd,of_SHLw),LAZY_DSHIFT(FS_D,cf_SHRd,of_SHLd),
+	{ FS_ZERO,0,cf_flag,flag_false,of_flag,0,0,0 },			/* t_MUL */
+	{ FS_ZERO,0,flag_false,flag_false,flag_false,0,0,0 },	/* t_DIV */
+	LAZY_BAD(cf_bad)										/* t_NOTDONE */
+};
+
 /* CF     Carry Flag -- Set on high-order bit carry or borrow; cleared
           otherwise.
 */
 Bit32u get_CF(void) {
-
-	switch (lflags.type) {
-	case t_UNKNOWN:
-	case t_INCb:
-	case t_INCw:
-	case t_INCd:
-	case t_DECb:
-	case t_DECw:
-	case t_DECd:
-	case t_MUL:
-		return GETFLAG(CF);
-	case t_ADDb:	
-		return (lf_resb<lf_var1b);
-	case t_ADDw:	
-		return (lf_resw<lf_var1w);
-	case t_ADDd:
-		return (lf_resd<lf_var1d);
-	case t_ADCb:
-		return (lf_resb < lf_var1b) || (lflags.oldcf && (lf_resb == lf_var1b));
-	case t_ADCw:
-		return (lf_resw < lf_var1w) || (lflags.oldcf && (lf_resw == lf_var1w));
-	case t_ADCd:
-		return (lf_resd < lf_var1d) || (lflags.oldcf && (lf_resd == lf_var1d));
-	case t_SBBb:
-		return (lf_var1b < lf_resb) || (lflags.oldcf && (lf_var2b==0xff));
-	case t_SBBw:
-		return (lf_var1w < lf_resw) || (lflags.oldcf && (lf_var2w==0xffff));
-	case t_SBBd:
-		return (lf_var1d < lf_resd) || (lflags.oldcf && (lf_var2d==0xffffffff));
-	case t_SUBb:
-	case t_CMPb:
-		return (lf_var1b<lf_var2b);
-	case t_SUBw:
-	case t_CMPw:
-		return (lf_var1w<lf_var2w);
-	case t_SUBd:
-	case t_CMPd:
-		return (lf_var1d<lf_var2d);
-	case t_SHLb:
-		if (lf_var2b>8) return false;
-		else return (lf_var1b >> (8-lf_var2b)) & 1;
-	case t_SHLw:
-		if (lf_var2b>16) return false;
-		else return (lf_var1w >> (16-lf_var2b)) & 1;
-	case t_SHLd:
-	case t_DSHLw:	/* Hmm this is not correct for shift higher than 16 */
-	case t_DSHLd:
-		return (lf_var1d >> (32 - lf_var2b)) & 1;
-	case t_RCRb:
-	case t_SHRb:
-		return (lf_var1b >> (lf_var2b - 1)) & 1;
-	case t_RCRw:
-	case t_SHRw:
-		return (lf_var1w >> (lf_var2b - 1)) & 1;
-	case t_RCRd:
-	case t_SHRd:
-	case t_DSHRw:	/* Hmm this is not correct for shift higher than 16 */
-	case t_DSHRd:
-		return (lf_var1d >> (lf_var2b - 1)) & 1;
-	case t_SARb:
-		return (((Bit8s) lf_var1b) >> (lf_var2b - 1)) & 1;
-	case t_SARw:
-		return (((Bit16s) lf_var1w) >> (lf_var2b - 1)) & 1;
-	case t_SARd:
-		return (((Bit32s) lf_var1d) >> (lf_var2b - 1)) & 1;
-	case t_NEGb:
-		return lf_var1b;
-	case t_NEGw:
-		return lf_var1w;
-	case t_NEGd:
-		return lf_var1d;
-	case t_ORb:
-	case t_ORw:
-	case t_ORd:
-	case t_ANDb:
-	case t_ANDw:
-	case t_ANDd:
-	case t_XORb:
-	case t_XORw:
-	case t_XORd:
-	case t_TESTb:
-	case t_TESTw:
-	case t_TESTd:
-		return false;	/* Set to false */
-	case t_DIV:
-		return false;	/* Unknown */
-	default:
-		LOG(LOG_CPU,LOG_ERROR)("get_CF Unknown %" sBitfs(d),lflags.type);
-	}
-	return 0;
+	return lazy_types[lflags.type].cf();
 }
 
 /* AF     Adjust flag -- Set on carry from or borrow to the low order
@@ -129,306 +173,32 @@ Bit32u get_CF(void) {
             arithmetic.
 */
 Bit32u get_AF(void) {
-	Bitu type=lflags.type;
-	switch (type) {
-	case t_UNKNOWN:
-		return GETFLAG(AF);
-	case t_ADDb:	
-	case t_ADCb:
-	case t_SBBb:
-	case t_SUBb:
-	case t_CMPb:
-		return ((lf_var1b ^ lf_var2b) ^ lf_resb) & 0x10;
-	case t_ADDw:
-	case t_ADCw:
-	case t_SBBw:
-	case t_SUBw:
-	case t_CMPw:
-		return ((lf_var1w ^ lf_var2w) ^ lf_resw) & 0x10;
-	case t_ADCd:
-	case t_ADDd:
-	case t_SBBd:
-	case t_SUBd:
-	case t_CMPd:
-		return ((lf_var1d ^ lf_var2d) ^ lf_resd) & 0x10;
-	case t_INCb:
-		return (lf_resb & 0x0f) == 0;
-	case t_INCw:
-		return (lf_resw & 0x0f) == 0;
-	case t_INCd:
-		return (lf_resd & 0x0f) == 0;
-	case t_DECb:
-		return (lf_resb & 0x0f) == 0x0f;
-	case t_DECw:
-		return (lf_resw & 0x0f) == 0x0f;
-	case t_DECd:
-		return (lf_resd & 0x0f) == 0x0f;
-	case t_NEGb:
-		return lf_var1b & 0x0f;
-	case t_NEGw:
-		return lf_var1w & 0x0f;
-	case t_NEGd:
-		return lf_var1d & 0x0f;
-	case t_SHLb:
-	case t_SHRb:
-	case t_SARb:
-		return lf_var2b & 0x1f;
-	case t_SHLw:
-	case t_SHRw:
-	case t_SARw:
-		return lf_var2w & 0x1f;
-	case t_SHLd:
-	case t_SHRd:
-	case t_SARd:
-		return lf_var2d & 0x1f;
-	case t_ORb:
-	case t_ORw:
-	case t_ORd:
-	case t_ANDb:
-	case t_ANDw:
-	case t_ANDd:
-	case t_XORb:
-	case t_XORw:
-	case t_XORd:
-	case t_TESTb:
-	case t_TESTw:
-	case t_TESTd:
-	case t_DSHLw:
-	case t_DSHLd:
-	case t_DSHRw:
-	case t_DSHRd:
-	case t_DIV:
-	case t_MUL:
-		return false;			          /* Unknown */
-	default:
-		LOG(LOG_CPU,LOG_ERROR)("get_AF Unknown %" sBitfs(d),lflags.type);
-	}
-	return 0;
+	return lazy_types[lflags.type].af();
 }
 
 /* ZF     Zero Flag -- Set if result is zero; cleared otherwise.
 */
-
 Bit32u get_ZF(void) {
-	Bitu type=lflags.type;
-	switch (type) {
-	case t_UNKNOWN:
-		return GETFLAG(ZF);
-	case t_ADDb:	
-	case t_ORb:
-	case t_ADCb:
-	case t_SBBb:
-	case t_ANDb:
-	case t_XORb:
-	case t_SUBb:
-	case t_CMPb:
-	case t_INCb:
-	case t_DECb:
-	case t_TESTb:
-	case t_SHLb:
-	case t_SHRb:
-	case t_SARb:
-	case t_NEGb:
-		return (lf_resb==0);
-	case t_ADDw:	
-	case t_ORw:
-	case t_ADCw:
-	case t_SBBw:
-	case t_ANDw:
-	case t_XORw:
-	case t_SUBw:
-	case t_CMPw:
-	case t_INCw:
-	case t_DECw:
-	case t_TESTw:
-	case t_SHLw:
-	case t_SHRw:
-	case t_SARw:
-	case t_DSHLw:
-	case t_DSHRw:
-	case t_NEGw:
-		return (lf_resw==0);
-	case t_ADDd:
-	case t_ORd:
-	case t_ADCd:
-	case t_SBBd:
-	case t_ANDd:
-	case t_XORd:
-	case t_SUBd:
-	case t_CMPd:
-	case t_INCd:
-	case t_DECd:
-	case t_TESTd:
-	case t_SHLd:
-	case t_SHRd:
-	case t_SARd:
-	case t_DSHLd:
-	case t_DSHRd:
-	case t_NEGd:
-		return (lf_resd==0);
-	case t_DIV:
-	case t_MUL:
-		return false;		/* Unknown */
-	default:
-		LOG(LOG_CPU,LOG_ERROR)("get_ZF Unknown %" sBitfs(d),lflags.type);
-	}
+	Bitu size=lazy_types[lflags.type].size;
+	if (GCC_LIKELY(size>=FS_B && size<=FS_D)) return (lflags.res.dword[DW_INDEX] & size_mask[size])==0;
+	if (size==FS_FLAGS) return GETFLAG(ZF);
+	if (size==FS_BAD) LOG(LOG_CPU,LOG_ERROR)("get_ZF Unknown %" sBitfs(d),lflags.type);
 	return false;
 }
+
 /* SF     Sign Flag -- Set equal to high-order bit of result (0 is
             positive, 1 if negative).
 */
 Bit32u get_SF(void) {
-	Bitu type=lflags.type;
-	switch (type) {
-	case t_UNKNOWN:
-		return GETFLAG(SF);
-	case t_ADDb:
-	case t_ORb:
-	case t_ADCb:
-	case t_SBBb:
-	case t_ANDb:
-	case t_XORb:
-	case t_SUBb:
-	case t_CMPb:
-	case t_INCb:
-	case t_DECb:
-	case t_TESTb:
-	case t_SHLb:
-	case t_SHRb:
-	case t_SARb:
-	case t_NEGb:
-		return	(lf_resb&0x80);
-	case t_ADDw:
-	case t_ORw:
-	case t_ADCw:
-	case t_SBBw:
-	case t_ANDw:
-	case t_XORw:
-	case t_SUBw:
-	case t_CMPw:
-	case t_INCw:
-	case t_DECw:
-	case t_TESTw:
-	case t_SHLw:
-	case t_SHRw:
-	case t_SARw:
-	case t_DSHLw:
-	case t_DSHRw:
-	case t_NEGw:
-		return	(lf_resw&0x8000);
-	case t_ADDd:
-	case t_ORd:
-	case t_ADCd:
-	case t_SBBd:
-	case t_ANDd:
-	case t_XORd:
-	case t_SUBd:
-	case t_CMPd:
-	case t_INCd:
-	case t_DECd:
-	case t_TESTd:
-	case t_SHLd:
-	case t_SHRd:
-	case t_SARd:
-	case t_DSHLd:
-	case t_DSHRd:
-	case t_NEGd:
-		return	(lf_resd&0x80000000);
-	case t_DIV:
-	case t_MUL:
-		return false;	/* Unknown */
-	default:
-		LOG(LOG_CPU,LOG_ERROR)("get_SF Unknown %" sBitfs(d),lflags.type);
-	}
+	Bitu size=lazy_types[lflags.type].size;
+	if (GCC_LIKELY(size>=FS_B && size<=FS_D)) return lflags.res.dword[DW_INDEX] & sign_mask[size];
+	if (size==FS_FLAGS) return GETFLAG(SF);
+	if (size==FS_BAD) LOG(LOG_CPU,LOG_ERROR)("get_SF Unknown %" sBitfs(d),lflags.type);
 	return false;
-
 }
+
 Bit32u get_OF(void) {
-	Bitu type=lflags.type;
-	switch (type) {
-	case t_UNKNOWN:
-	case t_MUL:
-		return GETFLAG(OF);
-	case t_ADDb:
-	case t_ADCb:
-		return ((lf_var1b ^ lf_var2b ^ 0x80) & (lf_resb ^ lf_var2b)) & 0x80;
-	case t_ADDw:
-	case t_ADCw:
-		return ((lf_var1w ^ lf_var2w ^ 0x8000) & (lf_resw ^ lf_var2w)) & 0x8000;
-	case t_ADDd:
-	case t_ADCd:
-		return ((lf_var1d ^ lf_var2d ^ 0x80000000) & (lf_resd ^ lf_var2d)) & 0x80000000;
-	case t_SBBb:
-	case t_SUBb:
-	case t_CMPb:
-		return ((lf_var1b ^ lf_var2b) & (lf_var1b ^ lf_resb)) & 0x80;
-	case t_SBBw:
-	case t_SUBw:
-	case t_CMPw:
-		return ((lf_var1w ^ lf_var2w) & (lf_var1w ^ lf_resw)) & 0x8000;
-	case t_SBBd:
-	case t_SUBd:
-	case t_CMPd:
-		return ((lf_var1d ^ lf_var2d) & (lf_var1d ^ lf_resd)) & 0x80000000;
-	case t_INCb:
-		return (lf_resb == 0x80);
-	case t_INCw:
-		return (lf_resw == 0x8000);
-	case t_INCd:
-		return (lf_resd == 0x80000000);
-	case t_DECb:
-		return (lf_resb == 0x7f);
-	case t_DECw:
-		return (lf_resw == 0x7fff);
-	case t_DECd:
-		return (lf_resd == 0x7fffffff);
-	case t_NEGb:
-		return (lf_var1b == 0x80);
-	case t_NEGw:
-		return (lf_var1w == 0x8000);
-	case t_NEGd:
-		return (lf_var1d == 0x80000000);
-	case t_SHLb:
-		return (lf_resb ^ lf_var1b) & 0x80;
-	case t_SHLw:
-	case t_DSHRw:
-	case t_DSHLw:
-		return (lf_resw ^ lf_var1w) & 0x8000;
-	case t_SHLd:
-	case t_DSHRd:
-	case t_DSHLd:
-		return (lf_resd ^ lf_var1d) & 0x80000000;
-	case t_SHRb:
-		if ((lf_var2b&0x1f)==1) return (lf_var1b > 0x80);
-		else return false;
-	case t_SHRw:
-		if ((lf_var2b&0x1f)==1) return (lf_var1w > 0x8000);
-		else return false;
-	case t_SHRd:
-		if ((lf_var2b&0x1f)==1) return (lf_var1d > 0x80000000);
-		else return false;
-	case t_ORb:
-	case t_ORw:
-	case t_ORd:
-	case t_ANDb:
-	case t_ANDw:
-	case t_ANDd:
-	case t_XORb:
-	case t_XORw:
-	case t_XORd:
-	case t_TESTb:
-	case t_TESTw:
-	case t_TESTd:
-	case t_SARb:
-	case t_SARw:
-	case t_SARd:
-		return false;			/* Return false */
-	case t_DIV:
-		return false;		/* Unknown */
-	default:
-		LOG(LOG_CPU,LOG_ERROR)("get_OF Unkown %" sBitfs(d),lflags.type);
-	}
-	return false;
+	return lazy_types[lflags.type].of();
 }
 
 Bit16u parity_lookup[256] = {
@@ -450,6 +220,7 @@ Bit16u parity_lookup[256] = {
   FLAG_PF, 0, 0, FLAG_PF, 0, FLAG_PF, FLAG_PF, 0, 0, FLAG_PF, FLAG_PF, 0, FLAG_PF, 0, 0, FLAG_PF
   };
 
+
 Bit32u get_PF(void) {
 	switch (lflags.type) {
 	case t_UNKNOWN:
@@ -460,729 +231,59 @@ Bit32u get_PF(void) {
 	return 0;
 }
 
-
-#if 0
-
-Bitu FillFlags(void) {
-//	if (lflags.type==t_UNKNOWN) return reg_flags;
-	Bitu new_word=(reg_flags & ~FLAG_MASK);
-	if (get_CF()) new_word|=FLAG_CF;
-	if (get_PF()) new_word|=FLAG_PF;
-	if (get_AF()) new_word|=FLAG_AF;
-	if (get_ZF()) new_word|=FLAG_ZF;
-	if (get_SF()) new_word|=FLAG_SF;
-	if (get_OF()) new_word|=FLAG_OF;
-	reg_flags=new_word;
-	lflags.type=t_UNKNOWN;
-	return reg_flags;
+/* Compound conditions, evaluated straight from the operands where the
+   lazy type allows it */
+Bit32u get_BE(void) {
+	LazyFlagGetter be=lazy_types[lflags.type].be;
+	if (be) return be();
+	return get_CF() || get_ZF();
 }
 
-#else
-
-#define DOFLAG_PF	reg_flags=(reg_flags & ~FLAG_PF) | parity_lookup[lf_resb];
-
-#define DOFLAG_AF	reg_flags=(reg_flags & ~FLAG_AF) | (((lf_var1b ^ lf_var2b) ^ lf_resb) & 0x10);
-
-#define DOFLAG_ZFb	SETFLAGBIT(ZF,lf_resb==0);
-#define DOFLAG_ZFw	SETFLAGBIT(ZF,lf_resw==0);
-#define DOFLAG_ZFd	SETFLAGBIT(ZF,lf_resd==0);
-
-#define DOFLAG_SFb	reg_flags=(reg_flags & ~FLAG_SF) | ((lf_resb & 0x80) >> 0);
-#define DOFLAG_SFw	reg_flags=(reg_flags & ~FLAG_SF) | ((lf_resw & 0x8000) >> 8);
-#define DOFLAG_SFd	reg_flags=(reg_flags & ~FLAG_SF) | ((lf_resd & 0x80000000) >> 24);
+Bit32u get_L(void) {
+	LazyFlagGetter l=lazy_types[lflags.type].l;
+	if (l) return l();
+	return (get_SF()!=0) != (get_OF()!=0);
+}
 
-#define SETCF(NEWBIT) reg_flags=(reg_flags & ~FLAG_CF)|(NEWBIT);
+Bit32u get_LE(void) {
+	LazyFlagGetter le=lazy_types[lflags.type].le;
+	if (le) return le();
+	return get_ZF() || ((get_SF()!=0) != (get_OF()!=0));
+}
 
-#define SET_FLAG SETFLAGBIT
+/* Write the flags in mask that the current lazy type defines */
+static INLINE bool FillLazyFlags(Bitu mask) {
+	const LazyFlagType & lt=lazy_types[lflags.type];
+	mask&=lt.fill;
+	if (GCC_UNLIKELY(!mask)) {
+		if (lt.size==FS_BAD) {
+			LOG(LOG_CPU,LOG_ERROR)("Unhandled flag type %" sBitfs(d),lflags.type);
+			return false;
+		}
+		return true;
+	}
+	Bit32u res=lflags.res.dword[DW_INDEX] & size_mask[lt.size];
+	Bitu new_flags=parity_lookup[lf_resb];
+	if (!res) new_flags|=FLAG_ZF;
+	if (res & sign_mask[lt.size]) new_flags|=FLAG_SF;
+	if ((mask & FLAG_CF) && lt.cf()) new_flags|=FLAG_CF;
+	if ((mask & FLAG_AF) && lt.af()) new_flags|=FLAG_AF;
+	if ((mask & FLAG_OF) && lt.of()) new_flags|=FLAG_OF;
+	reg_flags=(reg_flags & ~mask) | (new_flags & mask);
+	return true;
+}
 
 Bitu FillFlags(void) {
-	switch (lflags.type) {
-	case t_UNKNOWN:
-		break;
-	case t_ADDb:	
-		SET_FLAG(CF,(lf_resb<lf_var1b));
-		DOFLAG_AF;
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,((lf_var1b ^ lf_var2b ^ 0x80) & (lf_resb ^ lf_var1b)) & 0x80);
-		DOFLAG_PF;
-		break;
-	case t_ADDw:	
-		SET_FLAG(CF,(lf_resw<lf_var1w));
-		DOFLAG_AF;
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,((lf_var1w ^ lf_var2w ^ 0x8000) & (lf_resw ^ lf_var1w)) & 0x8000);
-		DOFLAG_PF;
-		break;
-	case t_ADDd:
-		SET_FLAG(CF,(lf_resd<lf_var1d));
-		DOFLAG_AF;
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,((lf_var1d ^ lf_var2d ^ 0x80000000) & (lf_resd ^ lf_var1d)) & 0x80000000);
-		DOFLAG_PF;
-		break;
-	case t_ADCb:
-		SET_FLAG(CF,(lf_resb < lf_var1b) || (lflags.oldcf && (lf_resb == lf_var1b)));
-		DOFLAG_AF;
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,((lf_var1b ^ lf_var2b ^ 0x80) & (lf_resb ^ lf_var1b)) & 0x80);
-		DOFLAG_PF;
-		break;
-	case t_ADCw:
-		SET_FLAG(CF,(lf_resw < lf_var1w) || (lflags.oldcf && (lf_resw == lf_var1w)));
-		DOFLAG_AF;
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,((lf_var1w ^ lf_var2w ^ 0x8000) & (lf_resw ^ lf_var1w)) & 0x8000);
-		DOFLAG_PF;
-		break;
-	case t_ADCd:
-		SET_FLAG(CF,(lf_resd < lf_var1d) || (lflags.oldcf && (lf_resd == lf_var1d)));
-		DOFLAG_AF;
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,((lf_var1d ^ lf_var2d ^ 0x80000000) & (lf_resd ^ lf_var1d)) & 0x80000000);
-		DOFLAG_PF;
-		break;
-
-
-	case t_SBBb:
-		SET_FLAG(CF,(lf_var1b < lf_resb) || (lflags.oldcf && (lf_var2b==0xff)));
-		DOFLAG_AF;
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,(lf_var1b ^ lf_var2b) & (lf_var1b ^ lf_resb) & 0x80);
-		DOFLAG_PF;
-		break;
-	case t_SBBw:
-		SET_FLAG(CF,(lf_var1w < lf_resw) || (lflags.oldcf && (lf_var2w==0xffff)));
-		DOFLAG_AF;
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,(lf_var1w ^ lf_var2w) & (lf_var1w ^ lf_resw) & 0x8000);
-		DOFLAG_PF;
-		break;
-	case t_SBBd:
-		SET_FLAG(CF,(lf_var1d < lf_resd) || (lflags.oldcf && (lf_var2d==0xffffffff)));
-		DOFLAG_AF;
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,(lf_var1d ^ lf_var2d) & (lf_var1d ^ lf_resd) & 0x80000000);
-		DOFLAG_PF;
-		break;
-	
-
-	case t_SUBb:
-	case t_CMPb:
-		SET_FLAG(CF,(lf_var1b<lf_var2b));
-		DOFLAG_AF;
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,(lf_var1b ^ lf_var2b) & (lf_var1b ^ lf_resb) & 0x80);
-		DOFLAG_PF;
-		break;
-	case t_SUBw:
-	case t_CMPw:
-		SET_FLAG(CF,(lf_var1w<lf_var2w));
-		DOFLAG_AF;
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,(lf_var1w ^ lf_var2w) & (lf_var1w ^ lf_resw) & 0x8000);
-		DOFLAG_PF;
-		break;
-	case t_SUBd:
-	case t_CMPd:
-		SET_FLAG(CF,(lf_var1d<lf_var2d));
-		DOFLAG_AF;
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,(lf_var1d ^ lf_var2d) & (lf_var1d ^ lf_resd) & 0x80000000);
-		DOFLAG_PF;
-		break;
-
-
-	case t_ORb:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-	case t_ORw:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-	case t_ORd:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-	
-	
-	case t_TESTb:
-	case t_ANDb:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-	case t_TESTw:
-	case t_ANDw:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-	case t_TESTd:
-	case t_ANDd:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-
-	
-	case t_XORb:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-	case t_XORw:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-	case t_XORd:
-		SET_FLAG(CF,false);
-		SET_FLAG(AF,false);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		break;
-
-
-	case t_SHLb:
-		if (lf_var2b>8) SET_FLAG(CF,false);
-		else SET_FLAG(CF,(lf_var1b >> (8-lf_var2b)) & 1);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,(lf_resb ^ lf_var1b) & 0x80);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2b&0x1f));
-		break;
-	case t_SHLw:
-		if (lf_var2b>16) SET_FLAG(CF,false);
-		else SET_FLAG(CF,(lf_var1w >> (16-lf_var2b)) & 1);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,(lf_resw ^ lf_var1w) & 0x8000);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2w&0x1f));
-		break;
-	case t_SHLd:
-		SET_FLAG(CF,(lf_var1d >> (32 - lf_var2b)) & 1);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,(lf_resd ^ lf_var1d) & 0x80000000);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2d&0x1f));
-		break;
-
-
-	case t_DSHLw:
-		SET_FLAG(CF,(lf_var1d >> (32 - lf_var2b)) & 1);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,(lf_resw ^ lf_var1w) & 0x8000);
-		DOFLAG_PF;
-		break;
-	case t_DSHLd:
-		SET_FLAG(CF,(lf_var1d >> (32 - lf_var2b)) & 1);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,(lf_resd ^ lf_var1d) & 0x80000000);
-		DOFLAG_PF;
-		break;
-
-
-	case t_SHRb:
-		SET_FLAG(CF,(lf_var1b >> (lf_var2b - 1)) & 1);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		if ((lf_var2b&0x1f)==1) SET_FLAG(OF,(lf_var1b >= 0x80));
-		else SET_FLAG(OF,false);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2b&0x1f));
-		break;
-	case t_SHRw:
-		SET_FLAG(CF,(lf_var1w >> (lf_var2b - 1)) & 1);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		if ((lf_var2w&0x1f)==1) SET_FLAG(OF,(lf_var1w >= 0x8000));
-		else SET_FLAG(OF,false);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2w&0x1f));
-		break;
-	case t_SHRd:
-		SET_FLAG(CF,(lf_var1d >> (lf_var2b - 1)) & 1);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		if ((lf_var2d&0x1f)==1) SET_FLAG(OF,(lf_var1d >= 0x80000000));
-		else SET_FLAG(OF,false);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2d&0x1f));
-		break;
-
-	
-	case t_DSHRw:	/* Hmm this is not correct for shift higher than 16 */
-		SET_FLAG(CF,(lf_var1d >> (lf_var2b - 1)) & 1);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,(lf_resw ^ lf_var1w) & 0x8000);
-		DOFLAG_PF;
-		break;
-	case t_DSHRd:
-		SET_FLAG(CF,(lf_var1d >> (lf_var2b - 1)) & 1);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,(lf_resd ^ lf_var1d) & 0x80000000);
-		DOFLAG_PF;
-		break;
-
-
-	case t_SARb:
-		SET_FLAG(CF,(((Bit8s) lf_var1b) >> (lf_var2b - 1)) & 1);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2b&0x1f));
-		break;
-	case t_SARw:
-		SET_FLAG(CF,(((Bit16s) lf_var1w) >> (lf_var2b - 1)) & 1);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2w&0x1f));
-		break;
-	case t_SARd:
-		SET_FLAG(CF,(((Bit32s) lf_var1d) >> (lf_var2b - 1)) & 1);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,false);
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2d&0x1f));
-		break;
-
-	case t_INCb:
-		SET_FLAG(AF,(lf_resb & 0x0f) == 0);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,(lf_resb == 0x80));
-		DOFLAG_PF;
-		break;
-	case t_INCw:
-		SET_FLAG(AF,(lf_resw & 0x0f) == 0);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,(lf_resw == 0x8000));
-		DOFLAG_PF;
-		break;
-	case t_INCd:
-		SET_FLAG(AF,(lf_resd & 0x0f) == 0);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,(lf_resd == 0x80000000));
-		DOFLAG_PF;
-		break;
-
-	case t_DECb:
-		SET_FLAG(AF,(lf_resb & 0x0f) == 0x0f);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,(lf_resb == 0x7f));
-		DOFLAG_PF;
-		break;
-	case t_DECw:
-		SET_FLAG(AF,(lf_resw & 0x0f) == 0x0f);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,(lf_resw == 0x7fff));
-		DOFLAG_PF;
-		break;
-	case t_DECd:
-		SET_FLAG(AF,(lf_resd & 0x0f) == 0x0f);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,(lf_resd == 0x7fffffff));
-		DOFLAG_PF;
-		break;
-
-	case t_NEGb:
-		SET_FLAG(CF,(lf_var1b!=0));
-		SET_FLAG(AF,(lf_resb & 0x0f) != 0);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		SET_FLAG(OF,(lf_var1b == 0x80));
-		DOFLAG_PF;
-		break;
-	case t_NEGw:
-		SET_FLAG(CF,(lf_var1w!=0));
-		SET_FLAG(AF,(lf_resw & 0x0f) != 0);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		SET_FLAG(OF,(lf_var1w == 0x8000));
-		DOFLAG_PF;
-		break;
-	case t_NEGd:
-		SET_FLAG(CF,(lf_var1d!=0));
-		SET_FLAG(AF,(lf_resd & 0x0f) != 0);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		SET_FLAG(OF,(lf_var1d == 0x80000000));
-		DOFLAG_PF;
-		break;
-
-	
-	case t_DIV:
-	case t_MUL:
-		break;
-
-	default:
-		LOG(LOG_CPU,LOG_ERROR)("Unhandled flag type %" sBitfs(d),lflags.type);
-		return 0;
-	}
+	if (!FillLazyFlags(FMASK_LAZY)) return 0;
 	lflags.type=t_UNKNOWN;
 	return reg_flags;
 }
 
 void FillFlagsNoCFOF(void) {
-	switch (lflags.type) {
-	case t_UNKNOWN:
-		return;
-	case t_ADDb:	
-		DOFLAG_AF;
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_ADDw:	
-		DOFLAG_AF;
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_ADDd:
-		DOFLAG_AF;
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-	case t_ADCb:
-		DOFLAG_AF;
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_ADCw:
-		DOFLAG_AF;
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_ADCd:
-		DOFLAG_AF;
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-
-	case t_SBBb:
-		DOFLAG_AF;
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_SBBw:
-		DOFLAG_AF;
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_SBBd:
-		DOFLAG_AF;
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-	
-
-	case t_SUBb:
-	case t_CMPb:
-		DOFLAG_AF;
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_SUBw:
-	case t_CMPw:
-		DOFLAG_AF;
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_SUBd:
-	case t_CMPd:
-		DOFLAG_AF;
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-
-	case t_ORb:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_ORw:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_ORd:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-	
-	
-	case t_TESTb:
-	case t_ANDb:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_TESTw:
-	case t_ANDw:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_TESTd:
-	case t_ANDd:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-	
-	case t_XORb:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_XORw:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_XORd:
-		SET_FLAG(AF,false);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-
-	case t_SHLb:
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2b&0x1f));
-		break;
-	case t_SHLw:
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2w&0x1f));
-		break;
-	case t_SHLd:
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2d&0x1f));
-		break;
-
-
-	case t_DSHLw:
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_DSHLd:
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-
-	case t_SHRb:
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2b&0x1f));
-		break;
-	case t_SHRw:
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2w&0x1f));
-		break;
-	case t_SHRd:
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2d&0x1f));
-		break;
-
-	
-	case t_DSHRw:	/* Hmm this is not correct for shift higher than 16 */
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_DSHRd:
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-
-	case t_SARb:
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2b&0x1f));
-		break;
-	case t_SARw:
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2w&0x1f));
-		break;
-	case t_SARd:
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		SET_FLAG(AF,(lf_var2d&0x1f));
-		break;
-
-	case t_INCb:
-		SET_FLAG(AF,(lf_resb & 0x0f) == 0);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_INCw:
-		SET_FLAG(AF,(lf_resw & 0x0f) == 0);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_INCd:
-		SET_FLAG(AF,(lf_resd & 0x0f) == 0);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-	case t_DECb:
-		SET_FLAG(AF,(lf_resb & 0x0f) == 0x0f);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_DECw:
-		SET_FLAG(AF,(lf_resw & 0x0f) == 0x0f);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_DECd:
-		SET_FLAG(AF,(lf_resd & 0x0f) == 0x0f);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-	case t_NEGb:
-		SET_FLAG(AF,(lf_resb & 0x0f) != 0);
-		DOFLAG_ZFb;
-		DOFLAG_SFb;
-		DOFLAG_PF;
-		break;
-	case t_NEGw:
-		SET_FLAG(AF,(lf_resw & 0x0f) != 0);
-		DOFLAG_ZFw;
-		DOFLAG_SFw;
-		DOFLAG_PF;
-		break;
-	case t_NEGd:
-		SET_FLAG(AF,(lf_resd & 0x0f) != 0);
-		DOFLAG_ZFd;
-		DOFLAG_SFd;
-		DOFLAG_PF;
-		break;
-
-	
-	case t_DIV:
-	case t_MUL:
-		break;
-
-	default:
-		LOG(LOG_CPU,LOG_ERROR)("Unhandled flag type %" sBitfs(d),lflags.type);
-		break;
-	}
+	FillLazyFlags(FMASK_LAZY & ~(FLAG_CF|FLAG_OF));
 	lflags.type=t_UNKNOWN;
 }
 
 void DestroyConditionFlags(void) {
 	lflags.type=t_UNKNOWN;
 }
-
-#endif
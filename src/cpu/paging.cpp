@@ -27,6 +27,7 @@
 #include "regs.h"
 #include "lazyflags.h"
 #include "cpu.h"
+#include "pic.h"
 #include "debug.h"
 #include "setup.h"
 
@@ -104,6 +105,8 @@ struct PF_Entry {
 	Bitu eip;
 	Bitu page_addr;
 	Bitu mpl;
+	bool trap;		// handler set TF, the next instruction is single stepped
+	bool stepped;	// a nested fault returned to a single stepped instruction
 };
 
 #define PF_QUEUESIZE 16
@@ -112,24 +115,59 @@ static struct {
 	PF_Entry entries[PF_QUEUESIZE];
 } pf_queue;
 
+/* Runs the guest fault handler on the normal core one instruction at a time,
+   within the cycles to the next event, until the faulting instruction is retried */
 static Bits PageFaultCore(void) {
-	CPU_CycleLeft+=CPU_Cycles;
-	CPU_Cycles=1;
-	Bits ret=CPU_Core_Full_Run();
-	CPU_CycleLeft+=CPU_Cycles;
-	if (ret<0) E_Exit("Got a dosbox close machine in pagefault core?");
-	if (ret) 
-		return ret;
 	if (!pf_queue.used) E_Exit("PF Core without PF");
 	PF_Entry * entry=&pf_queue.entries[pf_queue.used-1];
-	X86PageEntry pentry;
-	pentry.load=phys_readd(entry->page_addr);
-	if (pentry.block.p && entry->cs == SegValue(cs) && entry->eip==reg_eip) {
-		cpu.mpl=entry->mpl;
-		return -1;
+	while (CPU_Cycles>0) {
+		Bits budget=CPU_Cycles;
+		bool trap=entry->trap;
+		entry->trap=false;
+		cpu.trap_skip=false;
+		cpu.hlt.old_decoder=0;
+		Bits ret=CPU_Core_Normal_Nested_Run();
+		/* Single step like CPU_Core_Normal_Trap_Run, which would leave this
+		   decoder for the normal core when it's done */
+		if ((trap && !cpu.trap_skip) || entry->stepped) {
+			entry->stepped=false;
+			CPU_DebugException(DBINT_STEP,reg_eip);
+		}
+		if (cpudecoder==&CPU_Core_Normal_Trap_Run) {
+			cpudecoder=&PageFaultCore;
+			entry->trap=true;
+		} else if (cpudecoder!=&PageFaultCore && cpu.hlt.old_decoder!=&PageFaultCore) {
+			/* Any other core switch, like entering protected mode with the
+			   core on auto, takes effect once the fault is done */
+			cpudecoder=&PageFaultCore;
+		}
+		if (ret<0) E_Exit("Got a dosbox close machine in pagefault core?");
+		if (ret) 
+			return ret;
+		X86PageEntry pentry;
+		pentry.load=phys_readd(entry->page_addr);
+		if (pentry.block.p && entry->cs == SegValue(cs) && entry->eip==reg_eip) {
+			cpu.mpl=entry->mpl;
+			return -1;
+		}
+		/* The instruction switched decoders (HLT), ended the slice for an irq,
+		   a PIC event or an io delay, or enabled irqs */
+		if (cpudecoder!=&PageFaultCore || CPU_Cycles<budget-1) return 0;
+		if (GETFLAG(IF) && PIC_IRQCheck) return 0;
 	}
 	return 0;
 }
+
+/* The handler returned with TF set to the faulting instruction, which is
+   the single stepped one. It completes in the interrupted core, then this
+   raises the step exception and hands back. */
+static CPU_Decoder * pf_stepped_decoder;
+
+static Bits PageFaultSteppedCore(void) {
+	cpudecoder=pf_stepped_decoder;
+	CPU_DebugException(DBINT_STEP,reg_eip);
+	return 0;
+}
 #if C_DEBUG
 Bitu DEBUG_EnableDebugger(void);
 #endif
@@ -152,6 +190,8 @@ void PAGING_PageFault(PhysPt lin_addr,Bitu page_addr,Bitu faultcode) {
 	entry->eip=reg_eip;
 	entry->page_addr=page_addr;
 	entry->mpl=cpu.mpl;
+	entry->trap=false;
+	entry->stepped=false;
 	cpu.mpl=3;
 
 	CPU_Exception(EXCEPTION_PF,faultcode);
@@ -159,10 +199,20 @@ void PAGING_PageFault(PhysPt lin_addr,Bitu page_addr,Bitu faultcode) {
 //	DEBUG_EnableDebugger();
 #endif
 	DOSBOX_RunMachine();
+	bool trap=entry->trap;
 	pf_queue.used--;
 	LOG(LOG_PAGING,LOG_NORMAL)("Left PageFault for %x queue %d",lin_addr,pf_queue.used);
 	memcpy(&lflags,&old_lflags,sizeof(LazyFlags));
 	cpudecoder=old_cpudecoder;
+	if (trap) {
+		if (cpudecoder==&PageFaultCore) pf_queue.entries[pf_queue.used-1].stepped=true;
+		else {
+			pf_stepped_decoder=cpudecoder;
+			cpudecoder=&PageFaultSteppedCore;
+			CPU_CycleLeft+=CPU_Cycles;
+			CPU_Cycles=0;
+		}
+	}
 //	LOG_MSG("SS:%04x SP:%08X",SegValue(ss),reg_esp);
 }
 
@@ -643,6 +693,180 @@ bool PAGING_ForcePageInit(Bitu lin_addr) {
 	return false;
 }
 
+/* Elements from index on that stay in one page and do not wrap around the index mask,
+   zero if the first element itself crosses a page or the mask */
+static INLINE Bitu PAGING_StringSpan(PhysPt base,Bitu index,Bitu size,Bits dir,Bitu mask) {
+	Bitu offset=(base+index) & 4095;
+	if (offset+size>4096 || index>mask-(size-1)) return 0;
+	Bitu page,wrap;
+	if (dir>0) {
+		page=(4096-offset)/size;
+		wrap=(mask-index-(size-1))/size+1;
+	} else {
+		page=offset/size+1;
+		wrap=index/size+1;
+	}
+	return page<wrap ? page : wrap;
+}
+
+static INLINE Bit32u PAGING_StringRead(PhysPt addr,Bitu size) {
+	switch (size) {
+	case 1:return mem_readb_inline(addr);
+	case 2:return mem_readw_inline(addr);
+	default:return mem_readd_inline(addr);
+	}
+}
+
+static INLINE void PAGING_StringWrite(PhysPt addr,Bitu size,Bit32u val) {
+	switch (size) {
+	case 1:mem_writeb_inline(addr,(Bit8u)val);break;
+	case 2:mem_writew_inline(addr,(Bit16u)val);break;
+	default:mem_writed_inline(addr,val);break;
+	}
+}
+
+static INLINE Bit32u PAGING_StringHostRead(HostPt off,Bitu size) {
+	switch (size) {
+	case 1:return host_readb(off);
+	case 2:return host_readw(off);
+	default:return host_readd(off);
+	}
+}
+
+/* Work out the next run of elements that can be done through host memory.
+   Returns 0 if a single element has to go through the page handlers */
+static INLINE Bitu PAGING_StringRun(PhysPt base,Bitu index,Bitu size,Bits dir,Bitu mask,Bitu count,bool write,HostPt & host) {
+	Bitu todo=PAGING_StringSpan(base,index,size,dir,mask);
+	if (!todo) return 0;
+	PhysPt addr=base+index;
+	HostPt tlb_addr=write ? get_tlb_write(addr) : get_tlb_read(addr);
+	if (!tlb_addr) return 0;
+	host=tlb_addr+addr;
+	return todo<count ? todo : count;
+}
+
+void PAGING_StringMove(PhysPt dst_base,Bitu & di,PhysPt src_base,Bitu & si,Bitu & count,Bitu size,Bits dir,Bitu mask) {
+	Bits step=dir*(Bits)size;
+	while (count) {
+		HostPt src,dst;
+		Bitu todo=PAGING_StringRun(src_base,si,size,dir,mask,count,false,src);
+		if (todo) todo=PAGING_StringRun(dst_base,di,size,dir,mask,todo,true,dst);
+		if (!todo) {
+			PAGING_StringWrite(dst_base+di,size,PAGING_StringRead(src_base+si,size));
+			si=(si+step)&mask;di=(di+step)&mask;count--;
+			continue;
+		}
+		Bitu len=todo*size;
+		if (dir<0) {
+			src-=len-size;dst-=len-size;
+		}
+		/* An element by element copy reads back what it wrote if the
+		   destination runs ahead of the source, keep that pattern fill */
+		if (dir>0 ? (dst>src && dst<src+len) : (dst<src && src<dst+len)) {
+			if (dir>0) for (Bitu i=0;i<len;i+=size) memmove(dst+i,src+i,size);
+			else for (Bitu i=len;i>0;i-=size) memmove(dst+i-size,src+i-size,size);
+		} else memmove(dst,src,len);
+		si=(si+todo*step)&mask;di=(di+todo*step)&mask;count-=todo;
+	}
+}
+
+void PAGING_StringStore(PhysPt dst_base,Bitu & di,Bit32u val,Bitu & count,Bitu size,Bits dir,Bitu mask) {
+	Bits step=dir*(Bits)size;
+	while (count) {
+		HostPt dst;
+		Bitu todo=PAGING_StringRun(dst_base,di,size,dir,mask,count,true,dst);
+		if (!todo) {
+			PAGING_StringWrite(dst_base+di,size,val);
+			di=(di+step)&mask;count--;
+			continue;
+		}
+		Bitu len=todo*size;
+		if (dir<0) dst-=len-size;
+		switch (size) {
+		case 1:memset(dst,(Bit8u)val,len);break;
+		case 2:for (Bitu i=0;i<len;i+=2) host_writew(dst+i,(Bit16u)val);break;
+		default:for (Bitu i=0;i<len;i+=4) host_writed(dst+i,val);break;
+		}
+		di=(di+todo*step)&mask;count-=todo;
+	}
+}
+
+Bit32u PAGING_StringLoad(PhysPt src_base,Bitu & si,Bit32u val,Bitu & count,Bitu size,Bits dir,Bitu mask) {
+	Bits step=dir*(Bits)size;
+	while (count) {
+		HostPt src;
+		Bitu todo=PAGING_StringRun(src_base,si,size,dir,mask,count,false,src);
+		if (!todo) {
+			val=PAGING_StringRead(src_base+si,size);
+			si=(si+step)&mask;count--;
+			continue;
+		}
+		/* Only the last element of a run ends up in the register */
+		val=PAGING_StringHostRead(src+(Bits)(todo-1)*step,size);
+		si=(si+todo*step)&mask;count-=todo;
+	}
+	return val;
+}
+
+Bitu PAGING_StringScan(PhysPt dst_base,Bitu & di,Bit32u acc,bool rep_zero,Bit32u & val,Bitu & count,Bitu size,Bits dir,Bitu mask) {
+	Bits step=dir*(Bits)size;
+	Bitu done=0;
+	while (count) {
+		HostPt dst;
+		Bitu todo=PAGING_StringRun(dst_base,di,size,dir,mask,count,false,dst);
+		if (!todo) {
+			val=PAGING_StringRead(dst_base+di,size);
+			di=(di+step)&mask;count--;done++;
+			if ((acc==val)!=rep_zero) break;
+			continue;
+		}
+		Bitu i=0;
+		if (size==1 && dir>0 && !rep_zero) {
+			/* repne scasb searching forward */
+			HostPt found=(HostPt)memchr(dst,(Bit8u)acc,todo);
+			i=found ? (Bitu)(found-dst) : todo-1;
+			val=dst[i];
+			i++;
+		} else {
+			while (i<todo) {
+				val=PAGING_StringHostRead(dst,size);
+				dst+=step;i++;
+				if ((acc==val)!=rep_zero) break;
+			}
+		}
+		di=(di+i*step)&mask;count-=i;done+=i;
+		if ((acc==val)!=rep_zero) break;
+	}
+	return done;
+}
+
+Bitu PAGING_StringCompare(PhysPt dst_base,Bitu & di,PhysPt src_base,Bitu & si,bool rep_zero,Bit32u & val1,Bit32u & val2,Bitu & count,Bitu size,Bits dir,Bitu mask) {
+	Bits step=dir*(Bits)size;
+	Bitu done=0;
+	while (count) {
+		HostPt src,dst;
+		Bitu todo=PAGING_StringRun(src_base,si,size,dir,mask,count,false,src);
+		if (todo) todo=PAGING_StringRun(dst_base,di,size,dir,mask,todo,false,dst);
+		if (!todo) {
+			val1=PAGING_StringRead(src_base+si,size);
+			val2=PAGING_StringRead(dst_base+di,size);
+			si=(si+step)&mask;di=(di+step)&mask;count--;done++;
+			if ((val1==val2)!=rep_zero) break;
+			continue;
+		}
+		Bitu i=0;
+		while (i<todo) {
+			val1=PAGING_StringHostRead(src,size);
+			val2=PAGING_StringHostRead(dst,size);
+			src+=step;dst+=step;i++;
+			if ((val1==val2)!=rep_zero) break;
+		}
+		si=(si+i*step)&mask;di=(di+i*step)&mask;count-=i;done+=i;
+		if ((val1==val2)!=rep_zero) break;
+	}
+	return done;
+}
+
 #if defined(USE_FULL_TLB)
 void PAGING_InitTLB(void) {
 	for (Bitu i=0;i<TLB_SIZE;i++) {
@@ -655,6 +879,7 @@ void PAGING_InitTLB(void) {
 }
 
 void PAGING_ClearTLB(void) {
+	CPU_TableCachesInvalidate();
 	Bit32u * entries=&paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		Bitu page=*entries++;
@@ -754,6 +979,7 @@ void PAGING_InitTLB(void) {
 }
 
 void PAGING_ClearTLB(void) {
+	CPU_TableCachesInvalidate();
 	Bit32u * entries=&paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		Bitu page=*entries++;
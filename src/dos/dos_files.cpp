@@ -436,6 +436,20 @@ bool DOS_SeekFile(Bit16u entry,Bit32u * pos,Bit32u type,bool fcb) {
 	return Files[handle]->Seek(pos,type);
 }
 
+/* Copy the remainder of a file on the host when both handles are host files,
+ * returns false when the rest has to be copied through the handles */
+bool DOS_CopyFileRest(Bit16u source,Bit16u target) {
+	Bit32u handle_source = RealHandle(source);
+	Bit32u handle_target = RealHandle(target);
+	if (handle_source>=DOS_FILES || handle_target>=DOS_FILES) return false;
+	if (!Files[handle_source] || !Files[handle_source]->IsOpen()) return false;
+	if (!Files[handle_target] || !Files[handle_target]->IsOpen()) return false;
+	localFile * file_source = dynamic_cast<localFile*>(Files[handle_source]);
+	localFile * file_target = dynamic_cast<localFile*>(Files[handle_target]);
+	if (!file_source || !file_target || file_source == file_target) return false;
+	return file_source->CopyTo(file_target);
+}
+
 bool DOS_CloseFile(Bit16u entry, bool fcb, Bit8u * refcnt) {
 	Bit32u handle = fcb?entry:RealHandle(entry);
 	if (handle>=DOS_FILES) {
@@ -38,6 +38,7 @@
 #include "control.h"
 #include "inout.h"
 #include "dma.h"
+#include "keyboard.h"
 
 #ifdef __LIBRETRO__
 #include "deps/char8_t-remediation/char8_t-remediation.h"
@@ -1662,6 +1663,49 @@ static void KEYB_ProgramStart(Program * * make) {
 }
 
 
+class AUTOTYPE : public Program {
+public:
+	void Run(void);
+};
+
+void AUTOTYPE::Run(void) {
+	if (cmd->FindExist("/?",false) || cmd->FindExist("-?",false)) {
+		WriteOut(MSG_Get("PROGRAM_AUTOTYPE_SHOWHELP"));
+		return;
+	}
+	if (cmd->FindExist("-c",true)) {
+		KEYBOARD_ClrScript();
+		return;
+	}
+	bool bios_direct=cmd->FindExist("-b",true);
+	std::string text;
+	if (!cmd->GetStringRemain(text)) {
+		WriteOut(MSG_Get("PROGRAM_AUTOTYPE_PENDING"),(unsigned int)KEYBOARD_ScriptPending());
+		return;
+	}
+	/* strip surrounding quotes, they let the text start or end with blanks */
+	if (text.size()>=2 && text[0]=='"' && text[text.size()-1]=='"') text=text.substr(1,text.size()-2);
+	std::string keys;
+	for (size_t i=0;i<text.size();i++) {
+		if (text[i]!='\\' || i+1>=text.size()) {
+			keys+=text[i];
+			continue;
+		}
+		switch (text[++i]) {
+		case 'n': keys+='\r';break;
+		case 't': keys+='\t';break;
+		case 'b': keys+='\b';break;
+		case 'e': keys+='\033';break;
+		default: keys+=text[i];break;
+		}
+	}
+	if (!KEYBOARD_QueueText(keys.c_str(),bios_direct)) WriteOut(MSG_Get("PROGRAM_AUTOTYPE_UNMAPPED"));
+}
+
+static void AUTOTYPE_ProgramStart(Program * * make) {
+	*make=new AUTOTYPE;
+}
+
 void DOS_SetupPrograms(void) {
 	/*Add Messages */
 
@@ -1873,6 +1917,16 @@ void DOS_SetupPrograms(void) {
 	MSG_Add("PROGRAM_KEYB_INVALIDFILE","Keyboard file %s invalid\n");
 	MSG_Add("PROGRAM_KEYB_LAYOUTNOTFOUND","No layout in %s for codepage %i\n");
 	MSG_Add("PROGRAM_KEYB_INVCPFILE","None or invalid codepage file for layout %s\n\n");
+	MSG_Add("PROGRAM_AUTOTYPE_SHOWHELP",
+		"\033[32;1mAUTOTYPE\033[0m [-b] text\n\n"
+		"Types text into the keyboard as fast as the program reading it allows.\n"
+		"  \\n enter, \\t tab, \\b backspace, \\e escape, \\\\ backslash.\n"
+		"  -b: Let text go straight into the BIOS buffer while a program waits\n"
+		"      for keys with INT 16h.\n"
+		"  -c: Discard keys not typed yet.\n"
+		"  \033[32;1mAUTOTYPE\033[0m without text shows the number of pending keys.\n");
+	MSG_Add("PROGRAM_AUTOTYPE_PENDING","%u keys pending\n");
+	MSG_Add("PROGRAM_AUTOTYPE_UNMAPPED","Some characters have no key and were skipped\n");
 
 	/*regular setup*/
 	PROGRAMS_MakeFile("MOUNT.COM",MOUNT_ProgramStart);
@@ -1887,5 +1941,6 @@ void DOS_SetupPrograms(void) {
 	PROGRAMS_MakeFile("LOADROM.COM", LOADROM_ProgramStart);
 	PROGRAMS_MakeFile("IMGMOUNT.COM", IMGMOUNT_ProgramStart);
 	PROGRAMS_MakeFile("KEYB.COM", KEYB_ProgramStart);
+	PROGRAMS_MakeFile("AUTOTYPE.COM", AUTOTYPE_ProgramStart);
 
 }
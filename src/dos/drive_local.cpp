@@ -22,6 +22,15 @@
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#include <vector>
+#if defined (__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+#if !defined (WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#endif
 
 #include "dosbox.h"
 #include "dos_inc.h"
@@ -29,7 +38,157 @@
 #include "support.h"
 #include "cross.h"
 #include "inout.h"
+#include "timer.h"
+
+/* How long host metadata is trusted before it's looked up again. Changes made
+   through the drive drop the cache right away, this only bounds how long
+   changes made by other host programs can go unnoticed. */
+#define STAT_CACHE_TTL		1000
+#define STAT_CACHE_MAX		8192
+
+/* Read-only host handles of recently closed files, so engines that open, read
+   and close the same resource file for every asset skip the host open */
+#define HANDLE_POOL_SIZE	8
+
+static struct {
+	struct {
+		std::string name;
+		FILE * handle;
+		Bit64u inode;
+		Bit32u size;
+		time_t mtime;
+	} entries[HANDLE_POOL_SIZE];
+	Bitu used;
+	Bit32u opens,hits;
+} handle_pool;
+
+static void HandlePool_Remove(Bitu index) {
+	for (Bitu i=index+1;i<handle_pool.used;i++) handle_pool.entries[i-1]=handle_pool.entries[i];
+	handle_pool.used--;
+	handle_pool.entries[handle_pool.used].name.clear();
+}
+
+static void HandlePool_Put(const std::string & name,FILE * handle) {
+	struct stat host_stat;
+	if (fstat(fileno(handle),&host_stat)!=0) {
+		fclose(handle);
+		return;
+	}
+	if (handle_pool.used==HANDLE_POOL_SIZE) {
+		fclose(handle_pool.entries[0].handle);
+		HandlePool_Remove(0);
+	}
+	Bitu i=handle_pool.used++;
+	handle_pool.entries[i].name=name;
+	handle_pool.entries[i].handle=handle;
+	handle_pool.entries[i].inode=(Bit64u)host_stat.st_ino;
+	handle_pool.entries[i].size=(Bit32u)host_stat.st_size;
+	handle_pool.entries[i].mtime=host_stat.st_mtime;
+}
+
+static FILE * HandlePool_Get(const char * name) {
+	for (Bitu i=handle_pool.used;i-->0;) {
+		if (handle_pool.entries[i].name!=name) continue;
+		FILE * handle=handle_pool.entries[i].handle;
+		/* Not the stat cache, it may be a second behind a host program that
+		   replaced the file */
+		struct stat host_stat;
+		bool same=stat(name,&host_stat)==0 &&
+			handle_pool.entries[i].inode==(Bit64u)host_stat.st_ino &&
+			handle_pool.entries[i].size==(Bit32u)host_stat.st_size &&
+			handle_pool.entries[i].mtime==host_stat.st_mtime;
+		HandlePool_Remove(i);
+		if (!same) {
+			fclose(handle);
+			return 0;
+		}
+		/* also drops the EOF and error state of the previous user */
+		rewind(handle);
+		return handle;
+	}
+	return 0;
+}
 
+void localDrive::DropPooledHandles(const char * host_name) {
+	for (Bitu i=handle_pool.used;i-->0;) {
+		if (host_name && handle_pool.entries[i].name!=host_name) continue;
+		fclose(handle_pool.entries[i].handle);
+		HandlePool_Remove(i);
+	}
+}
+
+void localDrive::LoadHostStatDir(const std::string & host_dir,Bit32u ticks) {
+#if !defined (WIN32)
+	DIR * dir=opendir(host_dir.c_str());
+	if (!dir) return;
+	int fd=dirfd(dir);
+	std::string name(host_dir);
+	struct dirent * dentry;
+	struct stat entry_stat;
+	while ((dentry=readdir(dir))!=NULL) {
+		if (fstatat(fd,dentry->d_name,&entry_stat,0)!=0) continue;
+		name.resize(host_dir.size());
+		name+=dentry->d_name;
+		HostStat & st=statCache[name];
+		st.exists=true;
+		st.is_dir=(entry_stat.st_mode & S_IFDIR)!=0;
+		st.size=(Bit32u)entry_stat.st_size;
+		st.mtime=entry_stat.st_mtime;
+		st.inode=(Bit64u)entry_stat.st_ino;
+		st.ticks=ticks;
+	}
+	closedir(dir);
+#else
+	(void)host_dir;(void)ticks;
+#endif
+}
+
+bool localDrive::GetHostStat(const char * host_name,HostStat & st,bool whole_dir) {
+	Bit32u ticks=GetTicks();
+	std::string name(host_name);
+	std::unordered_map<std::string,HostStat>::const_iterator it=statCache.find(name);
+	if (it!=statCache.end() && ticks-it->second.ticks<STAT_CACHE_TTL) {
+		st=it->second;
+		return st.exists;
+	}
+	if (statCache.size()>=STAT_CACHE_MAX) DropHostStat();
+	if (whole_dir) {
+		/* Directory scans stat every entry, fetch them all at once */
+		size_t split=name.rfind(CROSS_FILESPLIT);
+		if (split!=std::string::npos) {
+			std::string dir(name,0,split+1);
+			std::unordered_map<std::string,Bit32u>::iterator loaded=statDirs.find(dir);
+			if (loaded==statDirs.end() || ticks-loaded->second>=STAT_CACHE_TTL) {
+				statDirs[dir]=ticks;
+				LoadHostStatDir(dir,ticks);
+				it=statCache.find(name);
+				if (it!=statCache.end() && ticks-it->second.ticks<STAT_CACHE_TTL) {
+					st=it->second;
+					return st.exists;
+				}
+			}
+		}
+	}
+	struct stat host_stat;
+	st.exists=(stat(host_name,&host_stat)==0);
+	st.is_dir=st.exists && (host_stat.st_mode & S_IFDIR);
+	st.size=st.exists ? (Bit32u)host_stat.st_size : 0;
+	st.mtime=st.exists ? host_stat.st_mtime : 0;
+	st.inode=st.exists ? (Bit64u)host_stat.st_ino : 0;
+	st.ticks=ticks;
+	statCache[name]=st;
+	return st.exists;
+}
+
+void localDrive::DropHostStat(void) {
+	statCache.clear();
+	statDirs.clear();
+}
+
+void localDrive::EmptyCache(void) {
+	DropHostStat();
+	DOS_Drive::EmptyCache();
+}
 
 bool localDrive::FileCreate(DOS_File * * file,char * name,Bit16u /*attributes*/) {
 //TODO Maybe care for attributes but not likely
@@ -40,6 +199,7 @@ bool localDrive::FileCreate(DOS_File * * file,char * name,Bit16u /*attributes*/)
 	char* temp_name = dirCache.GetExpandName(newname); //Can only be used in till a new drive_cache action is preformed */
 	/* Test if file exists (so we need to truncate it). don't add to dirCache then */
 	bool existing_file = false;
+	DropPooledHandles(temp_name);
 	
 	FILE * test = fopen_wrap(temp_name,"rb+");
 	if(test) {
@@ -55,6 +215,7 @@ bool localDrive::FileCreate(DOS_File * * file,char * name,Bit16u /*attributes*/)
 	}
    
 	if(!existing_file) dirCache.AddEntry(newname, true);
+	DropHostStat();
 	/* Make the 16 bit device information */
 	*file=new localFile(name,hand);
 	(*file)->flags=OPEN_READWRITE;
@@ -95,7 +256,15 @@ bool localDrive::FileOpen(DOS_File * * file,char * name,Bit32u flags) {
 		}
 	}
 
-	FILE * hand = fopen_wrap(newname,type);
+	FILE * hand = 0;
+	bool read_only = (flags&0xf)==OPEN_READ || (flags&0xf)==OPEN_READ_NO_MOD;
+	if (read_only) {
+		if (handle_pool.used) hand = HandlePool_Get(newname);
+		if (hand) handle_pool.hits++;
+		if ((++handle_pool.opens & 1023)==0)
+			LOG(LOG_FILES,LOG_NORMAL)("Host handle pool: %u of %u read-only opens reused",handle_pool.hits,handle_pool.opens);
+	} else DropPooledHandles(newname);
+	if (!hand) hand = fopen_wrap(newname,type);
 //	Bit32u err=errno;
 	if (!hand) { 
 		if((flags&0xf) != OPEN_READ) {
@@ -108,7 +277,10 @@ bool localDrive::FileOpen(DOS_File * * file,char * name,Bit32u flags) {
 		return false;
 	}
 
-	*file=new localFile(name,hand);
+	if (!read_only) DropHostStat();
+	localFile * lfile=new localFile(name,hand);
+	if (read_only) lfile->SetPoolName(newname);
+	*file=lfile;
 	(*file)->flags=flags;  //for the inheritance flag and maybe check for others.
 //	(*file)->SetFileName(newname);
 	return true;
@@ -140,6 +312,7 @@ bool localDrive::FileUnlink(char * name) {
 	strcat(newname,name);
 	CROSS_FILENAME(newname);
 	char *fullname = dirCache.GetExpandName(newname);
+	DropPooledHandles(fullname);
 	if (unlink(fullname)) {
 		//Unlink failed for some reason try finding it.
 		struct stat buffer;
@@ -177,12 +350,14 @@ bool localDrive::FileUnlink(char * name) {
 		}
 		if (!unlink(fullname)) {
 			dirCache.DeleteEntry(newname);
+			DropHostStat();
 			return true;
 		}
 		DOS_SetError(DOSERR_ACCESS_DENIED);
 		return false;
 	} else {
 		dirCache.DeleteEntry(newname);
+		DropHostStat();
 		return true;
 	}
 }
@@ -243,7 +418,7 @@ bool localDrive::FindFirst(char * _dir,DOS_DTA & dta,bool fcb_findfirst) {
 bool localDrive::FindNext(DOS_DTA & dta) {
 
 	char * dir_ent;
-	struct stat stat_block;
+	HostStat stat_block;
 	char full_name[CROSS_LEN];
 	char dir_entcopy[CROSS_LEN];
 
@@ -267,11 +442,11 @@ again:
 	//and due to its design dir_ent might be lost.)
 	//Copying dir_ent first
 	strcpy(dir_entcopy,dir_ent);
-	if (stat(dirCache.GetExpandName(full_name),&stat_block)!=0) { 
+	if (!GetHostStat(dirCache.GetExpandName(full_name),stat_block,true)) { 
 		goto again;//No symlinks and such
 	}	
 
-	if(stat_block.st_mode & S_IFDIR) find_attr=DOS_ATTR_DIRECTORY;
+	if(stat_block.is_dir) find_attr=DOS_ATTR_DIRECTORY;
 	else find_attr=DOS_ATTR_ARCHIVE;
  	if (~srch_attr & find_attr & (DOS_ATTR_DIRECTORY | DOS_ATTR_HIDDEN | DOS_ATTR_SYSTEM)) goto again;
 	
@@ -283,9 +458,9 @@ again:
 		upcase(find_name);
 	} 
 
-	find_size=(Bit32u) stat_block.st_size;
+	find_size=stat_block.size;
 	struct tm *time;
-	if((time=localtime(&stat_block.st_mtime))!=0){
+	if((time=localtime(&stat_block.mtime))!=0){
 		find_date=DOS_PackDate((Bit16u)(time->tm_year+1900),(Bit16u)(time->tm_mon+1),(Bit16u)time->tm_mday);
 		find_time=DOS_PackTime((Bit16u)time->tm_hour,(Bit16u)time->tm_min,(Bit16u)time->tm_sec);
 	} else {
@@ -303,10 +478,10 @@ bool localDrive::GetFileAttr(char * name,Bit16u * attr) {
 	CROSS_FILENAME(newname);
 	dirCache.ExpandName(newname);
 
-	struct stat status;
-	if (stat(newname,&status)==0) {
+	HostStat status;
+	if (GetHostStat(newname,status)) {
 		*attr=DOS_ATTR_ARCHIVE;
-		if(status.st_mode & S_IFDIR) *attr|=DOS_ATTR_DIRECTORY;
+		if(status.is_dir) *attr|=DOS_ATTR_DIRECTORY;
 		return true;
 	}
 	*attr=0;
@@ -323,7 +498,10 @@ bool localDrive::MakeDir(char * dir) {
 #else
 	int temp=mkdir(dirCache.GetExpandName(newdir),0700);
 #endif
-	if (temp==0) dirCache.CacheOut(newdir,true);
+	if (temp==0) {
+		dirCache.CacheOut(newdir,true);
+		DropHostStat();
+	}
 
 	return (temp==0);// || ((temp!=0) && (errno==EEXIST));
 }
@@ -333,8 +511,12 @@ bool localDrive::RemoveDir(char * dir) {
 	strcpy(newdir,basedir);
 	strcat(newdir,dir);
 	CROSS_FILENAME(newdir);
+	DropPooledHandles();
 	int temp=rmdir(dirCache.GetExpandName(newdir));
-	if (temp==0) dirCache.DeleteEntry(newdir,true);
+	if (temp==0) {
+		dirCache.DeleteEntry(newdir,true);
+		DropHostStat();
+	}
 	return (temp==0);
 }
 
@@ -348,9 +530,9 @@ bool localDrive::TestDir(char * dir) {
 	size_t len = strlen(newdir);
 	if (len && (newdir[len-1]!='\\')) {
 		// It has to be a directory !
-		struct stat test;
-		if (stat(newdir,&test))			return false;
-		if ((test.st_mode & S_IFDIR)==0)	return false;
+		HostStat test;
+		if (!GetHostStat(newdir,test))	return false;
+		return test.is_dir;
 	};
 	int temp=access(newdir,F_OK);
 	return (temp==0);
@@ -362,13 +544,19 @@ bool localDrive::Rename(char * oldname,char * newname) {
 	strcat(newold,oldname);
 	CROSS_FILENAME(newold);
 	dirCache.ExpandName(newold);
+	DropPooledHandles(newold);
 	
 	char newnew[CROSS_LEN];
 	strcpy(newnew,basedir);
 	strcat(newnew,newname);
 	CROSS_FILENAME(newnew);
-	int temp=rename(newold,dirCache.GetExpandName(newnew));
-	if (temp==0) dirCache.CacheOut(newnew);
+	char * expanded_new=dirCache.GetExpandName(newnew);
+	DropPooledHandles(expanded_new);
+	int temp=rename(newold,expanded_new);
+	if (temp==0) {
+		dirCache.CacheOut(newnew);
+		DropHostStat();
+	}
 	return (temp==0);
 
 }
@@ -387,9 +575,9 @@ bool localDrive::FileExists(const char* name) {
 	strcat(newname,name);
 	CROSS_FILENAME(newname);
 	dirCache.ExpandName(newname);
-	struct stat temp_stat;
-	if(stat(newname,&temp_stat)!=0) return false;
-	if(temp_stat.st_mode & S_IFDIR) return false;
+	HostStat temp_stat;
+	if(!GetHostStat(newname,temp_stat)) return false;
+	if(temp_stat.is_dir) return false;
 	return true;
 }
 
@@ -399,17 +587,17 @@ bool localDrive::FileStat(const char* name, FileStat_Block * const stat_block) {
 	strcat(newname,name);
 	CROSS_FILENAME(newname);
 	dirCache.ExpandName(newname);
-	struct stat temp_stat;
-	if(stat(newname,&temp_stat)!=0) return false;
+	HostStat temp_stat;
+	if(!GetHostStat(newname,temp_stat)) return false;
 	/* Convert the stat to a FileStat */
 	struct tm *time;
-	if((time=localtime(&temp_stat.st_mtime))!=0) {
+	if((time=localtime(&temp_stat.mtime))!=0) {
 		stat_block->time=DOS_PackTime((Bit16u)time->tm_hour,(Bit16u)time->tm_min,(Bit16u)time->tm_sec);
 		stat_block->date=DOS_PackDate((Bit16u)(time->tm_year+1900),(Bit16u)(time->tm_mon+1),(Bit16u)time->tm_mday);
 	} else {
 
 	}
-	stat_block->size=(Bit32u)temp_stat.st_size;
+	stat_block->size=temp_stat.size;
 	return true;
 }
 
@@ -427,6 +615,7 @@ bool localDrive::isRemovable(void) {
 }
 
 Bits localDrive::UnMount(void) { 
+	DropPooledHandles();
 	delete this;
 	return 0; 
 }
@@ -509,9 +698,18 @@ bool localFile::Seek(Bit32u * pos,Bit32u type) {
 bool localFile::Close() {
 	// only close if one reference left
 	if (refCtr==1) {
-		if(fhandle) fclose(fhandle);
+		if (fhandle) {
+			if (!pool_name.empty()) HandlePool_Put(pool_name,fhandle);
+			else fclose(fhandle);
+		}
 		fhandle = 0;
 		open = false;
+		// size and date may have changed, don't serve them from the drive's cache
+		Bit32u mode = flags & 0xf;
+		if (mode != OPEN_READ && mode != OPEN_READ_NO_MOD && GetDrive() < DOS_DRIVES) {
+			localDrive * drive = dynamic_cast<localDrive*>(Drives[GetDrive()]);
+			if (drive) drive->DropHostStat();
+		}
 	};
 	return true;
 }
@@ -559,6 +757,62 @@ void localFile::Flush(void) {
 	}
 }
 
+/* Copy everything from the current position to the end of the file to the
+ * target on the host. Positions are left after the copied data, even when
+ * it stops early, so a caller can finish the copy itself. */
+bool localFile::CopyTo(localFile * target) {
+	Bit32u source_mode = flags & 0xf;
+	Bit32u target_mode = target->flags & 0xf;
+	if (source_mode == OPEN_WRITE) return false;
+	if (target_mode == OPEN_READ || target_mode == OPEN_READ_NO_MOD) return false;
+	if (!fhandle || !target->fhandle) return false;
+
+	if (fflush(target->fhandle) != 0) return false;
+	long in_pos = ftell(fhandle);
+	long out_pos = ftell(target->fhandle);
+	struct stat source_stat;
+	if (in_pos < 0 || out_pos < 0 || fstat(fileno(fhandle),&source_stat) != 0) return false;
+	long end = (long)source_stat.st_size;
+
+#if defined (__linux__) && defined (SYS_copy_file_range)
+	/* Let the kernel move the data, filesystems that support it share the
+	 * extents. Called through syscall() as neither older glibc nor bionic
+	 * have the wrapper; on ENOSYS, EXDEV, EINVAL and the like the loop
+	 * below copies the rest. */
+	static bool have_copy_file_range = true;
+	int in_fd = fileno(fhandle), out_fd = fileno(target->fhandle);
+	while (have_copy_file_range && in_pos < end) {
+		loff_t in_off = in_pos, out_off = out_pos;
+		long done = syscall(SYS_copy_file_range,in_fd,&in_off,out_fd,&out_off,(size_t)(end - in_pos),0u);
+		if (done <= 0) {
+			if (done < 0 && errno == ENOSYS) have_copy_file_range = false;
+			break;
+		}
+		in_pos += done;
+		out_pos += done;
+	}
+#endif
+	if (in_pos < end) {
+		static std::vector<Bit8u> buffer(1024*1024);
+		fseek(fhandle,in_pos,SEEK_SET);
+		fseek(target->fhandle,out_pos,SEEK_SET);
+		while (in_pos < end) {
+			size_t want = (size_t)(end - in_pos);
+			if (want > buffer.size()) want = buffer.size();
+			size_t got = fread(&buffer[0],1,want,fhandle);
+			size_t put = got ? fwrite(&buffer[0],1,got,target->fhandle) : 0;
+			in_pos += (long)put;
+			out_pos += (long)put;
+			if (put == 0 || put != want) break;
+		}
+	}
+	fseek(fhandle,in_pos,SEEK_SET);
+	fseek(target->fhandle,out_pos,SEEK_SET);
+	last_action = NONE;
+	target->last_action = NONE;
+	return in_pos >= end;
+}
+
 
 // ********************************************
 // CDROM DRIVE
@@ -660,6 +914,7 @@ bool cdromDrive::isRemovable(void) {
 
 Bits cdromDrive::UnMount(void) {
 	if(MSCDEX_RemoveDrive(driveLetter)) {
+		DropPooledHandles();
 		delete this;
 		return 0;
 	}
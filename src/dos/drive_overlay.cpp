@@ -280,6 +280,9 @@ bool OverlayFile::create_copy() {
 	size_t s;
 	while ( (s = fread(buffer,1,BUFSIZ,lhandle)) != 0 ) fwrite(buffer, 1, s, newhandle);
 	fclose(lhandle);
+	//The overlay copy shadows the base file from now on, don't keep handles to it around
+	if (*GetPoolName()) localDrive::DropPooledHandles(GetPoolName());
+	SetPoolName("");
 	//Set copied file handle to position of the old one 
 	fseek(newhandle,location_in_old_file,SEEK_SET);
 	this->fhandle = newhandle;
@@ -297,6 +300,7 @@ static OverlayFile* ccc(DOS_File* file) {
 	OverlayFile* ret = new OverlayFile(l->GetName(),l->fhandle);
 	ret->flags = l->flags;
 	ret->refCtr = l->refCtr;
+	ret->SetPoolName(l->GetPoolName());
 	delete l;
 	return ret;
 }
@@ -1197,6 +1201,7 @@ bool Overlay_Drive::FileStat(const char* name, FileStat_Block * const stat_block
 }
 
 Bits Overlay_Drive::UnMount(void) { 
+	DropPooledHandles();
 	delete this;
 	return 0; 
 }
@@ -22,6 +22,7 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <sys/types.h>
 #include "dos_system.h"
 #include "shell.h" /* for DOS_Shell */
@@ -71,9 +72,23 @@ public:
 	virtual bool isRemote(void);
 	virtual bool isRemovable(void);
 	virtual Bits UnMount(void);
+	virtual void EmptyCache(void);
+	void DropHostStat(void);
+	static void DropPooledHandles(const char * host_name=0);
 	const char* getBasedir() {return basedir;};
 protected:
 	char basedir[CROSS_LEN];
+	/* Host metadata, cached for a short while so repeated probes and
+	   directory scans don't hit the host filesystem every time */
+	struct HostStat {
+		bool exists;
+		bool is_dir;
+		Bit32u size;
+		time_t mtime;
+		Bit64u inode;
+		Bit32u ticks;
+	};
+	bool GetHostStat(const char * host_name,HostStat & st,bool whole_dir=false);
 private:
 	friend void DOS_Shell::CMD_SUBST(char* args);
 protected:
@@ -82,6 +97,9 @@ protected:
 	} srchInfo[MAX_OPENDIRS];
 
 private:
+	void LoadHostStatDir(const std::string & host_dir,Bit32u ticks);
+	std::unordered_map<std::string,HostStat> statCache;
+	std::unordered_map<std::string,Bit32u> statDirs;
 	struct {
 		Bit16u bytes_sector;
 		Bit8u sectors_cluster;
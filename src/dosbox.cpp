@@ -140,6 +140,7 @@ void TIMER_Init(Section*);
 void BIOS_Init(Section*);
 void DEBUG_Init(Section*);
 void CMOS_Init(Section*);
+void REPLAY_Init(Section*);
 
 void MSCDEX_Init(Section*);
 void DRIVES_Init(Section*);
@@ -486,6 +487,18 @@ void DOSBOX_Init(void) {
 	secprop->AddInitFunction(&PROGRAMS_Init);
 	secprop->AddInitFunction(&TIMER_Init);//done
 	secprop->AddInitFunction(&CMOS_Init);//done
+	Pstring = secprop->Add_path("inputrecord",Property::Changeable::OnlyAtStart,"");
+	Pstring->Set_help("Record keyboard, mouse and joystick input with its emulated time to this file.\n"
+		"Cycles are kept fixed while recording so the session can be replayed exactly.");
+
+	Pstring = secprop->Add_path("inputreplay",Property::Changeable::OnlyAtStart,"");
+	Pstring->Set_help("Replay input recorded with inputrecord. Live input is ignored until the end of the recording.");
+
+	Pint = secprop->Add_int("replayhash",Property::Changeable::OnlyAtStart,1000);
+	Pint->SetMinMax(0,60000);
+	Pint->Set_help("Milliseconds of emulated time between memory hashes stored while recording.\n"
+		"A replay compares them to check it stays identical. 0 disables them.");
+	secprop->AddInitFunction(&REPLAY_Init);
 
 	secprop=control->AddSection_prop("render",&RENDER_Init,true);
 	Pint = secprop->Add_int("frameskip",Property::Changeable::Always,0);
@@ -570,6 +583,15 @@ void DOSBOX_Init(void) {
 	Pint->SetMinMax(1,1000000);
 	Pint->Set_help("Setting it lower than 100 will be a percentage.");
 
+	Pint = secprop->Add_int("faultstats",Property::Changeable::Always,0);
+	Pint->SetMinMax(0,3600);
+	Pint->Set_help("Report counts of exceptions by vector and CS:EIP, page faults by linear page,\n"
+		"I/O faults by port and V86 software interrupts every this many seconds.\n"
+		"0 disables the counting.");
+
+	Pstring = secprop->Add_string("faultstatsfile",Property::Changeable::Always,"");
+	Pstring->Set_help("File the fault statistics are appended to. Empty writes them to the log.");
+
 #if C_FPU
 	secprop->AddInitFunction(&FPU_Init);
 #endif
@@ -759,6 +781,10 @@ void DOSBOX_Init(void) {
 	Pbool = secprop->Add_bool("disney",Property::Changeable::WhenIdle,true);
 	Pbool->Set_help("Enable Disney Sound Source emulation. (Covox Voice Master and Speech Thing compatible).");
 
+	Pint = secprop->Add_int("disneyrate",Property::Changeable::WhenIdle,44100);
+	Pint->Set_values(rates);
+	Pint->Set_help("Sample rate the Disney Sound Source and Covox output is resampled to.");
+
 	secprop=control->AddSection_prop("joystick",&BIOS_Init,false);//done
 	secprop->AddInitFunction(&INT10_Init);
 	secprop->AddInitFunction(&MOUSE_Init); //Must be after int10 as it uses CurMode
@@ -159,8 +159,18 @@ bool RENDER_StartUpdate(void) {
 		return false;
 	if (GCC_UNLIKELY(!render.active))
 		return false;
+	if (GCC_UNLIKELY(render.discard)) {
+#ifdef __LIBRETRO__
+		// A skipped frame still ends here for the frontend
+		RENDER_EndUpdate(false);
+#endif
+		return false;
+	}
 	if (GCC_UNLIKELY(render.frameskip.count<render.frameskip.max)) {
 		render.frameskip.count++;
+#ifdef __LIBRETRO__
+		RENDER_EndUpdate(false);
+#endif
 		return false;
 	}
 	render.frameskip.count=0;
@@ -560,8 +570,8 @@ static void RENDER_CallBack( GFX_CallBackFunctions_t function ) {
 }
 
 void RENDER_SetSize(Bitu width,Bitu height,Bitu bpp,float fps,double ratio,bool dblw,bool dblh) {
-	RENDER_Halt( );
 	if (!width || !height || width > SCALER_MAXWIDTH || height > SCALER_MAXHEIGHT) { 
+		RENDER_Halt( );
 		return;	
 	}
 	if ( ratio > 1 ) {
@@ -570,6 +580,13 @@ void RENDER_SetSize(Bitu width,Bitu height,Bitu bpp,float fps,double ratio,bool
 	} else {
 		//This would alter the width of the screen, we don't care about rounding errors here
 	}
+	/* Only the refresh rate changed, scalers and output can stay as they are */
+	if (render.active && !render.updating && width==render.src.width && height==render.src.height &&
+		bpp==render.src.bpp && dblw==render.src.dblw && dblh==render.src.dblh && ratio==render.src.ratio) {
+		render.src.fps=fps;
+		return;
+	}
+	RENDER_Halt( );
 	render.src.width=width;
 	render.src.height=height;
 	render.src.bpp=bpp;
@@ -617,6 +634,12 @@ void RENDER_SetForceUpdate(bool f) {
 	render.forceUpdate = f;
 }
 
+/* Frames nobody will look at are neither drawn nor scaled, the
+ * scaler cache still matches the last frame that was output */
+void RENDER_SetDiscard(bool discard) {
+	render.discard = discard;
+}
+
 #if C_OPENGL
 static bool RENDER_GetShader(std::string& shader_path, char *old_src) {
 	char* src;
@@ -843,6 +843,8 @@ Module::Module( Section* configuration ) : Module_base(configuration) {
 	mixerChan = mixerObject.Install(OPL_CallBack,rate,"FM");
 	//Used to be 2.0, which was measured to be too high. Exact value depends on card/clone.
 	mixerChan->SetScale( 1.5f );  
+	//Register writes and timers don't depend on the generated samples
+	mixerChan->synthesized = true;
 
 	if (oplemu == "compat") {
 		if ( oplmode == OPL_opl2 ) {
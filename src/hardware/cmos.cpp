@@ -27,6 +27,7 @@
 #include "mem.h"
 #include "bios_disk.h"
 #include "setup.h"
+#include "replay.h"
 #include "cross.h" //fmod on certain platforms
 
 static struct {
@@ -137,6 +138,9 @@ static Bitu cmos_readreg(Bitu /*port*/,Bitu /*iolen*/) {
 
 	/* Convert it to local time representation. */
 	loctime = localtime (&curtime);
+	struct tm replaytime;
+	Bit32u milli;
+	if (REPLAY_LocalTime(replaytime,milli)) loctime=&replaytime;
 
 	switch (cmos.reg) {
 	case 0x00:		/* Seconds */
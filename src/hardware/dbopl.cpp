@@ -50,6 +50,8 @@ namespace DBOPL {
 
 #define OPLRATE		((double)(14318180.0 / 288.0))
 #define TREMOLO_TABLE 52
+//Samples of envelope output calculated ahead per operator
+#define VOLUME_BLOCK 64
 
 //Try to use most precision for frequencies
 //Else try to keep different waves in synch
@@ -444,6 +446,45 @@ INLINE Bitu Operator::ForwardVolume() {
 	return currentLevel + (this->*volHandler)();
 }
 
+//Step the envelope while it stays in the same state, the volume handler only changes with it
+template< Operator::State yes>
+Bitu Operator::TemplateVolumes( Bitu index, Bitu samples, Bitu* vols ) {
+	for ( ; index < samples && state == yes; index++ )
+		vols[ index ] = currentLevel + TemplateVolume< yes >();
+	return index;
+}
+
+//The envelope doesn't depend on the wave output, so a whole block can be done up front
+void Operator::ForwardVolumes( Bitu samples, Bitu* vols ) {
+	Bitu i = 0;
+	while ( i < samples ) {
+		switch ( state ) {
+		case OFF:
+			//Nothing changes until the next register write, fill the rest of the block
+			for ( ; i < samples; i++ )
+				vols[ i ] = currentLevel + ENV_MAX;
+			break;
+		case RELEASE:
+			i = TemplateVolumes< RELEASE >( i, samples, vols );
+			break;
+		case SUSTAIN:
+			if ( reg20 & MASK_SUSTAIN ) {
+				for ( ; i < samples; i++ )
+					vols[ i ] = currentLevel + volume;
+				break;
+			}
+			i = TemplateVolumes< SUSTAIN >( i, samples, vols );
+			break;
+		case DECAY:
+			i = TemplateVolumes< DECAY >( i, samples, vols );
+			break;
+		case ATTACK:
+			i = TemplateVolumes< ATTACK >( i, samples, vols );
+			break;
+		}
+	}
+}
+
 
 INLINE Bitu Operator::ForwardWave() {
 	waveIndex += waveCurrent;	
@@ -588,8 +629,7 @@ INLINE Bits Operator::GetWave( Bitu index, Bitu vol ) {
 #endif
 }
 
-Bits INLINE Operator::GetSample( Bits modulation ) {
-	Bitu vol = ForwardVolume();
+Bits INLINE Operator::GetSample( Bits modulation, Bitu vol ) {
 	if ( ENV_SILENT( vol ) ) {
 		//Simply forward the wave
 		waveIndex += waveCurrent;
@@ -601,6 +641,10 @@ Bits INLINE Operator::GetSample( Bits modulation ) {
 	}
 }
 
+Bits INLINE Operator::GetSample( Bits modulation ) {
+	return GetSample( modulation, ForwardVolume() );
+}
+
 Operator::Operator() {
 	chanData = 0;
 	freqMul = 0;
@@ -896,59 +940,79 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 		Op( 4 )->Prepare( chip );
 		Op( 5 )->Prepare( chip );
 	}
-	for ( Bitu i = 0; i < samples; i++ ) {
-		//Early out for percussion handlers
-		if ( mode == sm2Percussion ) {
+	//Early out for percussion handlers
+	if ( mode == sm2Percussion ) {
+		for ( Bitu i = 0; i < samples; i++ )
 			GeneratePercussion<false>( chip, output + i );
-			continue;	//Prevent some unitialized value bitching
-		} else if ( mode == sm3Percussion ) {
+		return( this + 3 );
+	} else if ( mode == sm3Percussion ) {
+		for ( Bitu i = 0; i < samples; i++ )
 			GeneratePercussion<true>( chip, output + i * 2 );
-			continue;	//Prevent some unitialized value bitching
-		}
-
-		//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
-		Bit32s mod = (Bit32u)((old[0] + old[1])) >> feedback;
-		old[0] = old[1];
-		old[1] = Op(0)->GetSample( mod );
-		Bit32s sample;
-		Bit32s out0 = old[0];
-		if ( mode == sm2AM || mode == sm3AM ) {
-			sample = out0 + Op(1)->GetSample( 0 );
-		} else if ( mode == sm2FM || mode == sm3FM ) {
-			sample = Op(1)->GetSample( out0 );
-		} else if ( mode == sm3FMFM ) {
-			Bits next = Op(1)->GetSample( out0 ); 
-			next = Op(2)->GetSample( next );
-			sample = Op(3)->GetSample( next );
-		} else if ( mode == sm3AMFM ) {
-			sample = out0;
-			Bits next = Op(1)->GetSample( 0 ); 
-			next = Op(2)->GetSample( next );
-			sample += Op(3)->GetSample( next );
-		} else if ( mode == sm3FMAM ) {
-			sample = Op(1)->GetSample( out0 );
-			Bits next = Op(2)->GetSample( 0 );
-			sample += Op(3)->GetSample( next );
-		} else if ( mode == sm3AMAM ) {
-			sample = out0;
-			Bits next = Op(1)->GetSample( 0 ); 
-			sample += Op(2)->GetSample( next );
-			sample += Op(3)->GetSample( 0 );
+		return( this + 3 );
+	}
+	//Envelopes are stepped per operator ahead of the samples, in chunks
+	Bitu vols[ 4 ][ VOLUME_BLOCK ];
+	Bit32s samps[ VOLUME_BLOCK ];
+	const Bitu ops = ( mode > sm4Start ) ? 4 : 2;
+	for ( Bitu start = 0; start < samples; start += VOLUME_BLOCK ) {
+		Bitu todo = samples - start;
+		if ( todo > VOLUME_BLOCK )
+			todo = VOLUME_BLOCK;
+		for ( Bitu o = 0; o < ops; o++ )
+			Op( o )->ForwardVolumes( todo, vols[ o ] );
+		for ( Bitu c = 0; c < todo; c++ ) {
+			//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
+			Bit32s mod = (Bit32u)((old[0] + old[1])) >> feedback;
+			old[0] = old[1];
+			old[1] = Op(0)->GetSample( mod, vols[0][c] );
+			Bit32s sample;
+			Bit32s out0 = old[0];
+			if ( mode == sm2AM || mode == sm3AM ) {
+				sample = out0 + Op(1)->GetSample( 0, vols[1][c] );
+			} else if ( mode == sm2FM || mode == sm3FM ) {
+				sample = Op(1)->GetSample( out0, vols[1][c] );
+			} else if ( mode == sm3FMFM ) {
+				Bits next = Op(1)->GetSample( out0, vols[1][c] ); 
+				next = Op(2)->GetSample( next, vols[2][c] );
+				sample = Op(3)->GetSample( next, vols[3][c] );
+			} else if ( mode == sm3AMFM ) {
+				sample = out0;
+				Bits next = Op(1)->GetSample( 0, vols[1][c] ); 
+				next = Op(2)->GetSample( next, vols[2][c] );
+				sample += Op(3)->GetSample( next, vols[3][c] );
+			} else if ( mode == sm3FMAM ) {
+				sample = Op(1)->GetSample( out0, vols[1][c] );
+				Bits next = Op(2)->GetSample( 0, vols[2][c] );
+				sample += Op(3)->GetSample( next, vols[3][c] );
+			} else if ( mode == sm3AMAM ) {
+				sample = out0;
+				Bits next = Op(1)->GetSample( 0, vols[1][c] ); 
+				sample += Op(2)->GetSample( next, vols[2][c] );
+				sample += Op(3)->GetSample( 0, vols[3][c] );
+			}
+			samps[ c ] = sample;
 		}
+		//Mixing into the output is independent per sample, keep it out of the serial chain
 		switch( mode ) {
 		case sm2AM:
 		case sm2FM:
-			output[ i ] += sample;
+			for ( Bitu c = 0; c < todo; c++ )
+				output[ start + c ] += samps[ c ];
 			break;
 		case sm3AM:
 		case sm3FM:
 		case sm3FMFM:
 		case sm3AMFM:
 		case sm3FMAM:
-		case sm3AMAM:
-			output[ i * 2 + 0 ] += sample & maskLeft;
-			output[ i * 2 + 1 ] += sample & maskRight;
-			break;
+		case sm3AMAM: {
+			//Local copies, the masks could otherwise alias the output
+			const Bit32s left = maskLeft;
+			const Bit32s right = maskRight;
+			for ( Bitu c = 0; c < todo; c++ ) {
+				output[ ( start + c ) * 2 + 0 ] += samps[ c ] & left;
+				output[ ( start + c ) * 2 + 1 ] += samps[ c ] & right;
+			}
+			break; }
 		}
 	}
 	switch( mode ) {
@@ -144,12 +144,16 @@ public:
 
 	template< State state>
 	Bits TemplateVolume( );
+	template< State state>
+	Bitu TemplateVolumes( Bitu index, Bitu samples, Bitu* vols );
+	void ForwardVolumes( Bitu samples, Bitu* vols );
 
 	Bit32s RateForward( Bit32u add );
 	Bitu ForwardWave();
 	Bitu ForwardVolume();
 
 	Bits GetSample( Bits modulation );
+	Bits GetSample( Bits modulation, Bitu vol );
 	Bits GetWave( Bitu index, Bitu vol );
 public:
 	Operator();
@@ -18,6 +18,7 @@
 
 
 #include <string.h>
+#include <math.h>
 #include "dosbox.h"
 #include "inout.h"
 #include "mixer.h"
@@ -30,15 +31,35 @@
 
 #define DISNEY_BASE 0x0378
 
-#define DISNEY_SIZE 128
+/* Pending DAC writes per channel */
+#define DISNEY_RING 1024
+#define DISNEY_MAXSAMPLES 2048
+
+/* The Sound Source plays its 16 byte FIFO at a fixed rate */
+#define DISNEY_FIFO_SIZE 16
+#define DISNEY_FIFO_RATE 7000.0
+
+/*
+	Every DAC write is stored with its time. The mixer callback turns each
+	change of the DAC level into a band limited step at its exact position,
+	so the output does not depend on guessing the rate the game plays at.
+	The step is built from a windowed sinc impulse added into an accumulator,
+	the running sum of that accumulator is the output.
+*/
+#define BLEP_TAPS 16
+#define BLEP_PHASES 32
+#define BLEP_DELAY (BLEP_TAPS/2-1)
+#define BLEP_CUTOFF 0.9
 
 typedef struct _dac_channel {
-	Bit8u buffer[DISNEY_SIZE];	// data buffer
-	Bitu used;					// current data buffer level
-	double speedcheck_sum;
-	double speedcheck_last;
-	bool speedcheck_failed;
-	bool speedcheck_init;
+	struct {
+		double time;
+		Bit8u val;
+	} ring[DISNEY_RING];
+	Bitu head,used;
+	Bit8u level;				// DAC level after the last queued write
+	float sum;					// running sum of the accumulator
+	float accum[DISNEY_MAXSAMPLES+BLEP_TAPS];
 } dac_channel;
 
 static struct {
@@ -52,134 +73,72 @@ static struct {
 	Bitu last_used;
 	MixerObject * mo;
 	MixerChannel * chan;
+	Bitu rate;
 	bool stereo;
-	// which channel do we use for mono output?
-	// and the channel used for stereo
-	dac_channel* leader;
+	// playback time of the last byte in the FIFO
+	double fifo_end;
 
-	Bitu state;
 	Bitu interface_det;
 	Bitu interface_det_ext;
 } disney;
 
-#define DS_IDLE 0
-#define DS_RUNNING 1
-#define DS_FINISH 2
-#define DS_ANALYZING 3
+static float blep[BLEP_PHASES][BLEP_TAPS];
+
+static void DISNEY_MakeBlep(void) {
+	const double pi = 3.14159265358979323846;
+	for (Bitu p = 0; p < BLEP_PHASES; p++) {
+		double total = 0;
+		double kernel[BLEP_TAPS];
+		for (Bitu k = 0; k < BLEP_TAPS; k++) {
+			double x = (double)k - BLEP_DELAY - (double)p / BLEP_PHASES;
+			double sinc = (x == 0) ? 1.0 : sin(pi * BLEP_CUTOFF * x) / (pi * BLEP_CUTOFF * x);
+			/* Blackman window over the full kernel width */
+			double w = (x + BLEP_TAPS / 2.0) / BLEP_TAPS;
+			double window = 0.42 - 0.5 * cos(2 * pi * w) + 0.08 * cos(4 * pi * w);
+			kernel[k] = sinc * window;
+			total += kernel[k];
+		}
+		/* Every phase adds up to a full step */
+		for (Bitu k = 0; k < BLEP_TAPS; k++) blep[p][k] = (float)(kernel[k] / total);
+	}
+}
 
-static void DISNEY_CallBack(Bitu len);
+static void DISNEY_ClearChannel(dac_channel & da) {
+	da.head = da.used = 0;
+	da.level = 0x80;
+	da.sum = 0;
+	memset(da.accum,0,sizeof(da.accum));
+}
 
 static void DISNEY_disable(Bitu) {
 	if (disney.mo) {
 		disney.chan->AddSilence();
 		disney.chan->Enable(false);
 	}
-	disney.leader = 0;
 	disney.last_used = 0;
-	disney.state = DS_IDLE;
 	disney.interface_det = 0;
 	disney.interface_det_ext = 0;
 	disney.stereo = false;
+	disney.fifo_end = 0;
+	DISNEY_ClearChannel(disney.da[0]);
+	DISNEY_ClearChannel(disney.da[1]);
 }
 
-static void DISNEY_enable(Bitu freq) {
-	if (freq < 500 || freq > 100000) {
-		// try again..
-		disney.state = DS_IDLE;
-		return;	
-	} else {
-#if 0
-		if(disney.stereo) LOG(LOG_MISC,LOG_NORMAL)("disney enable %d Hz, stereo",freq);
-		else LOG(LOG_MISC,LOG_NORMAL)("disney enable %d Hz, mono",freq);
-#endif
-		disney.chan->SetFreq(freq);
-		disney.chan->Enable(true);
-		disney.state = DS_RUNNING;
-	}
+static void DISNEY_Latch(Bitu channel,double time) {
+	dac_channel & da = disney.da[channel];
+	if (da.used == DISNEY_RING) return;	// overflow, the mixer is not running
+	Bitu pos = (da.head + da.used) % DISNEY_RING;
+	da.ring[pos].time = time;
+	da.ring[pos].val = disney.data;
+	da.used++;
+	if (channel) disney.stereo = true;
+	if (!disney.chan->enabled) disney.chan->Enable(true);
 }
 
-static void DISNEY_analyze(Bitu channel){
-	switch(disney.state) {
-		case DS_RUNNING: // should not get here
-			break;
-		case DS_IDLE:
-			// initialize channel data
-			for(int i = 0; i < 2; i++) {
-				disney.da[i].used = 0;
-				disney.da[i].speedcheck_sum = 0;
-				disney.da[i].speedcheck_failed = false;
-				disney.da[i].speedcheck_init = false;
-			}
-			disney.da[channel].speedcheck_last = PIC_FullIndex();
-			disney.da[channel].speedcheck_init = true;
-
-			disney.state = DS_ANALYZING;
-			break;
-
-		case DS_FINISH: 
-		{
-			// detect stereo: if we have about the same data amount in both channels
-			Bits st_diff = disney.da[0].used - disney.da[1].used;
-
-			// find leader channel (the one with higher rate) [this good for the stereo case?]
-			if (disney.da[0].used > disney.da[1].used) {
-				//disney.monochannel=0;
-				disney.leader = &disney.da[0];
-			} else {
-				//disney.monochannel=1;
-				disney.leader = &disney.da[1];
-			}
-
-			if ((st_diff < 5) && (st_diff > -5)) disney.stereo = true;
-			else disney.stereo = false;
-
-			// calculate rate for both channels
-			Bitu ch_speed[2];
-
-			for(Bitu i = 0; i < 2; i++) {
-				if (disney.da[i].used > 1) { // avoid dividing by zero
-					ch_speed[i] = (Bitu)(1.0/((disney.da[i].speedcheck_sum/1000.0) /
-					(float)(((float)disney.da[i].used)-1.0))); // -1.75
-				} else ch_speed[i] = 0;
-			}
-
-			// choose the larger value
-			DISNEY_enable(ch_speed[0] > ch_speed[1]?
-				ch_speed[0]:ch_speed[1]); // TODO
-			break;
-		}
-		case DS_ANALYZING:
-		{
-			double current = PIC_FullIndex();
-			dac_channel* cch = &disney.da[channel];
-
-			if (!cch->speedcheck_init) {
-				cch->speedcheck_init = true;
-				cch->speedcheck_last = current;
-				break;
-			}
-			cch->speedcheck_sum += current - cch->speedcheck_last;
-			//LOG_MSG("t=%f",current - cch->speedcheck_last);
-
-			// sanity checks (printer...)
-			if ((current - cch-> speedcheck_last) < 0.01 ||
-				(current - cch-> speedcheck_last) > 2)
-				cch->speedcheck_failed = true;
-
-			// if both are failed we are back at start
-			if (disney.da[0].speedcheck_failed && disney.da[1].speedcheck_failed) {
-				disney.state = DS_IDLE;
-				break;
-			}
-
-			cch->speedcheck_last = current;
-
-			// analyze finish condition
-			if (disney.da[0].used > 30 || disney.da[1].used > 30)
-				disney.state = DS_FINISH;
-			break;
-		}
-	}
+static Bitu DISNEY_FifoLevel(void) {
+	double left = disney.fifo_end - PIC_FullIndex();
+	if (left <= 0) return 0;
+	return (Bitu)ceil(left * DISNEY_FIFO_RATE / 1000.0);
 }
 
 static void disney_write(Bitu port,Bitu val,Bitu /*iolen*/) {
@@ -191,17 +150,8 @@ static void disney_write(Bitu port,Bitu val,Bitu /*iolen*/) {
 		disney.data=val;
 		// if data is written here too often without using the stereo
 		// mechanism we use the simple DAC machanism.
-		if (disney.state != DS_RUNNING) {
-			disney.interface_det++;
-			if(disney.interface_det > 5)
-				DISNEY_analyze(0);
-		}
-		if (disney.interface_det > 5) {
-			if(disney.da[0].used < DISNEY_SIZE) {
-				disney.da[0].buffer[disney.da[0].used] = disney.data;
-				disney.da[0].used++;
-			} //else LOG_MSG("disney overflow 0");
-		}
+		if (disney.interface_det <= 5) disney.interface_det++;
+		if (disney.interface_det > 5) DISNEY_Latch(0,PIC_FullIndex());
 		break;
 	}
 	case 1:		/* Status Port */
@@ -209,47 +159,28 @@ static void disney_write(Bitu port,Bitu val,Bitu /*iolen*/) {
 		break;
 	case 2:		/* Control Port */
 		if ((disney.control & 0x2) && !(val & 0x2)) {
-			if(disney.state != DS_RUNNING) {
-				disney.interface_det = 0;
-				disney.interface_det_ext = 0;
-				DISNEY_analyze(1);
-			}
-
+			disney.interface_det = 0;
+			disney.interface_det_ext = 0;
 			// stereo channel latch
-			if (disney.da[1].used < DISNEY_SIZE) {
-				disney.da[1].buffer[disney.da[1].used] = disney.data;
-				disney.da[1].used++;
-			} //else LOG_MSG("disney overflow 1");
+			DISNEY_Latch(1,PIC_FullIndex());
 		}
 
 		if ((disney.control & 0x1) && !(val & 0x1)) {
-			if(disney.state != DS_RUNNING) {
-				disney.interface_det = 0;
-				disney.interface_det_ext = 0;
-				DISNEY_analyze(0);
-			}
+			disney.interface_det = 0;
+			disney.interface_det_ext = 0;
 			// stereo channel latch
-			if (disney.da[0].used < DISNEY_SIZE) {
-				disney.da[0].buffer[disney.da[0].used] = disney.data;
-				disney.da[0].used++;
-			} //else LOG_MSG("disney overflow 0");
+			DISNEY_Latch(0,PIC_FullIndex());
 		}
 
 		if ((disney.control & 0x8) && !(val & 0x8)) {
 			// emulate a device with 16-byte sound FIFO
-			if (disney.state != DS_RUNNING) {
-				disney.interface_det_ext++;
-				disney.interface_det = 0;
-				if(disney.interface_det_ext > 5) {
-					disney.leader = &disney.da[0];
-					DISNEY_enable(7000);
-				}
-			}
+			disney.interface_det = 0;
+			if (disney.interface_det_ext <= 5) disney.interface_det_ext++;
 			if (disney.interface_det_ext > 5) {
-				if(disney.da[0].used < DISNEY_SIZE) {
-					disney.da[0].buffer[disney.da[0].used] = disney.data;
-					disney.da[0].used++;
-				}
+				double now = PIC_FullIndex();
+				if (disney.fifo_end < now) disney.fifo_end = now;
+				DISNEY_Latch(0,disney.fifo_end);
+				disney.fifo_end += 1000.0 / DISNEY_FIFO_RATE;
 			}
 		}
 
@@ -271,7 +202,7 @@ static Bitu disney_read(Bitu port,Bitu /*iolen*/){
 //		LOG(LOG_MISC,"DISNEY:Read from status port %X",disney.status);
 		retval = 0x07;//0x40; // Stereo-on-1 and (or) New-Stereo DACs present
 		if (disney.interface_det_ext > 5) {
-			if (disney.leader && disney.leader->used >= 16){
+			if (DISNEY_FifoLevel() >= DISNEY_FIFO_SIZE){
 				retval |= 0x40; // ack
 				retval &= ~0x4; // interrupt
 			}
@@ -287,75 +218,58 @@ static Bitu disney_read(Bitu port,Bitu /*iolen*/){
 	return 0xff;
 }
 
-static void DISNEY_PlayStereo(Bitu len, Bit8u* l, Bit8u* r) {
-	static Bit8u stereodata[DISNEY_SIZE*2];
-	for(Bitu i = 0; i < len; i++) {
-		stereodata[i*2] = l[i];
-		stereodata[i*2+1] = r[i];
+/* Turn the writes that happened up to end into steps and render len samples starting at start */
+static void DISNEY_Render(dac_channel & da,float * out,Bitu len,double start,double end) {
+	const double samples_per_ms = disney.rate / 1000.0;
+	while (da.used && da.ring[da.head].time < end) {
+		Bit8u val = da.ring[da.head].val;
+		double pos = (da.ring[da.head].time - start) * samples_per_ms;
+		da.head = (da.head + 1) % DISNEY_RING;
+		da.used--;
+		if (val == da.level) continue;
+		if (pos < 0) pos = 0;
+		Bitu index = (Bitu)pos;
+		if (index >= len) index = len - 1;
+		Bitu phase = (Bitu)((pos - index) * BLEP_PHASES);
+		if (phase >= BLEP_PHASES) phase = BLEP_PHASES - 1;
+		float delta = (float)(((Bits)val - (Bits)da.level) << 8);
+		da.level = val;
+		float * accum = &da.accum[index];
+		for (Bitu k = 0; k < BLEP_TAPS; k++) accum[k] += delta * blep[phase][k];
+	}
+	float sum = da.sum;
+	for (Bitu i = 0; i < len; i++) {
+		sum += da.accum[i];
+		out[i] = sum;
 	}
-	disney.chan->AddSamples_s8(len,stereodata);
+	/* Move the tails of the steps to the start */
+	memmove(da.accum,&da.accum[len],BLEP_TAPS*sizeof(float));
+	memset(&da.accum[BLEP_TAPS],0,len*sizeof(float));
+	/* Snap to the exact level once all steps have settled */
+	bool settled = true;
+	for (Bitu k = 0; k < BLEP_TAPS; k++) {
+		if (da.accum[k] != 0) { settled = false; break; }
+	}
+	da.sum = settled ? (float)(((Bits)da.level - 0x80) << 8) : sum;
 }
 
 static void DISNEY_CallBack(Bitu len) {
-	if (!len) return;
-
-	// get the smaller used
-	Bitu real_used;
-	if (disney.stereo) {
-		real_used = disney.da[0].used;
-		if(disney.da[1].used < real_used) real_used = disney.da[1].used;
-	} else
-		real_used = disney.leader->used;
-
-	if (real_used >= len) { // enough data for now
-		if (disney.stereo) DISNEY_PlayStereo(len, disney.da[0].buffer, disney.da[1].buffer);
-		else disney.chan->AddSamples_m8(len,disney.leader->buffer);
-
-		// put the rest back to start
-		for(int i = 0; i < 2; i++) {
-			// TODO for mono only one 
-			memmove(disney.da[i].buffer,&disney.da[i].buffer[len],DISNEY_SIZE/*real_used*/-len);
-			disney.da[i].used -= len;
-		}
-	// TODO: len > DISNEY
-	} else { // not enough data
-		if(disney.stereo) {
-			Bit8u gapfiller0 = 0x80;
-			Bit8u gapfiller1 = 0x80;
-			if (real_used) {
-				gapfiller0 = disney.da[0].buffer[real_used-1];
-				gapfiller1 = disney.da[1].buffer[real_used-1];
-			};
-
-			memset(disney.da[0].buffer+real_used,
-				gapfiller0,len-real_used);
-			memset(disney.da[1].buffer+real_used,
-				gapfiller1,len-real_used);
-
-			DISNEY_PlayStereo(len, disney.da[0].buffer, disney.da[1].buffer);
-			len -= real_used;
-
-		} else { // mono
-			Bit8u gapfiller = 0x80; //Keep the middle
-			if (real_used) {
-				// fix for some stupid game; it outputs 0 at the end of the stream
-				// causing a click. So if we have at least two bytes availible in the
-				// buffer and the last one is a 0 then ignore that.
-				if(disney.leader->buffer[real_used-1]==0)
-					real_used--;
-			}
-			// do it this way because AddSilence sounds like a gnawing mouse
-			if (real_used)
-				gapfiller = disney.leader->buffer[real_used-1];
-			//LOG_MSG("gapfiller %x, fill len %d, realused %d",gapfiller,len-real_used,real_used);
-			memset(disney.leader->buffer+real_used,	gapfiller, len-real_used);
-			disney.chan->AddSamples_m8(len, disney.leader->buffer);
-		}
-		disney.da[0].used =0;
-		disney.da[1].used =0;
-
-		//LOG_MSG("disney underflow %d",len - real_used);
+	if (!len || len > DISNEY_MAXSAMPLES) return;
+	/* The samples asked for end at the current time */
+	double end = PIC_FullIndex();
+	double start = end - len * 1000.0 / disney.rate;
+
+	float left[DISNEY_MAXSAMPLES],right[DISNEY_MAXSAMPLES];
+	DISNEY_Render(disney.da[0],left,len,start,end);
+	DISNEY_Render(disney.da[1],right,len,start,end);
+
+	float stereodata[DISNEY_MAXSAMPLES*2];
+	for (Bitu i = 0; i < len; i++) {
+		stereodata[i*2] = left[i];
+		stereodata[i*2+1] = disney.stereo ? right[i] : left[i];
 	}
+	disney.chan->AddSamples_sfloat(len,stereodata);
+
 	if (disney.last_used+100<PIC_Ticks) {
 		// disable sound output
 		PIC_AddEvent(DISNEY_disable,0.0001f);	// I think we shouldn't delete the 
@@ -379,9 +293,11 @@ public:
 		disney.status=0x84;
 		disney.control=0;
 		disney.last_used=0;
+		disney.rate=section->Get_int("disneyrate");
+		DISNEY_MakeBlep();
 
 		disney.mo = new MixerObject();
-		disney.chan=disney.mo->Install(&DISNEY_CallBack,10000,"DISNEY");
+		disney.chan=disney.mo->Install(&DISNEY_CallBack,disney.rate,"DISNEY");
 		DISNEY_disable(0);
 
 
@@ -27,68 +27,333 @@
 #include <cstring>
 #include <math.h>
 
-#include "mame/emu.h"
-#include "mame/saa1099.h"
+/*
+	SAA1099 emulation, based on saa1099.c of the M.A.M.E. project.
+
+	Register writes are queued with their position inside the current tick and
+	applied while rendering, so a write lands on the sample it was made at.
+	Tone and noise generators are advanced from edge to edge instead of once
+	per chip clock, each output sample is the average level of the waveform
+	over that sample's time.
+*/
 
 #define MASTER_CLOCK 7159090
+#define CMS_ENTRIES 1024
+#define CMS_MAXSAMPLES 2048
+
+static const float amplitude_lookup[16] = {
+	 0*32767/16,  1*32767/16,  2*32767/16,  3*32767/16,
+	 4*32767/16,  5*32767/16,  6*32767/16,  7*32767/16,
+	 8*32767/16,  9*32767/16, 10*32767/16, 11*32767/16,
+	12*32767/16, 13*32767/16, 14*32767/16, 15*32767/16
+};
+
+static const Bit8u envelope[8][64] = {
+	/* zero amplitude */
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	/* maximum amplitude */
+	{15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,
+	 15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,
+	 15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,
+	 15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,15 },
+	/* single decay */
+	{15,14,13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	/* repetitive decay */
+	{15,14,13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+	 15,14,13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+	 15,14,13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+	 15,14,13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 },
+	/* single triangular */
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,
+	 15,14,13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	/* repetitive triangular */
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,
+	 15,14,13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+	  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,
+	 15,14,13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 },
+	/* single attack */
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	/* repetitive attack */
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,
+	  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,
+	  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,
+	  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15 }
+};
+
+struct SAA1099 {
+	struct {
+		Bit8u frequency,octave;
+		bool freq_enable,noise_enable;
+		float amplitude[2];
+		Bit8u envelope[2];		/* 0x00..0x0f or 0x10 == off */
+		Bit8u level;
+		double remain;			/* master clocks until the next edge */
+	} channels[6];
+	struct {
+		Bit32u level;
+		double remain;
+	} noise[2];
+	Bit8u noise_params[2];
+	bool env_enable[2],env_reverse_right[2],env_bits[2],env_clock[2];
+	Bit8u env_mode[2],env_step[2];
+	bool all_ch_enable;
+	Bit8u selected_reg;
+};
+
+struct CmsEntry {
+	float index;
+	Bit8u chip,port,val;
+};
+
+static struct {
+	MixerChannel * chan;
+	SAA1099 saa[2];
+	double clocks_per_sample;
+	CmsEntry entries[CMS_ENTRIES];
+	Bitu used;
+} cms;
 
-//My mixer channel
-static MixerChannel * cms_chan;
 //Timer to disable the channel after a while
 static Bit32u lastWriteTicks;
 static Bit32u cmsBase;
-static saa1099_device* device[2];
 
-static void write_cms(Bitu port, Bitu val, Bitu /* iolen */) {
-	if(cms_chan && (!cms_chan->enabled)) cms_chan->Enable(true);
-	lastWriteTicks = PIC_Ticks;
-	switch ( port - cmsBase ) {
-	case 1:
-		device[0]->control_w(0, 0, val);
+/* Half a period of a tone generator in master clocks */
+static INLINE double SAA_HalfPeriod(const SAA1099 & saa,Bitu ch) {
+	return (double)((511 - saa.channels[ch].frequency) << (8 - saa.channels[ch].octave));
+}
+
+static double SAA_NoisePeriod(const SAA1099 & saa,Bitu ch) {
+	if (saa.noise_params[ch] == 3) return SAA_HalfPeriod(saa,ch*3);
+	return (double)(128 << saa.noise_params[ch]);
+}
+
+static void SAA_Envelope(SAA1099 & saa,Bitu ch) {
+	Bit8u left,right;
+	if (saa.env_enable[ch]) {
+		Bitu mode = saa.env_mode[ch];
+		/* step from 0..63 and then loop in steps 32..63 */
+		Bitu step = saa.env_step[ch] = ((saa.env_step[ch] + 1) & 0x3f) | (saa.env_step[ch] & 0x20);
+		Bit8u mask = saa.env_bits[ch] ? 14 : 15;	/* 3 bit resolution, mask LSB */
+		left = envelope[mode][step] & mask;
+		right = saa.env_reverse_right[ch] ? ((15 - envelope[mode][step]) & mask) : left;
+	} else {
+		/* envelope mode off, set all envelope factors to 16 */
+		left = right = 16;
+	}
+	for (Bitu i = ch*3; i < ch*3 + 3; i++) {
+		saa.channels[i].envelope[0] = left;
+		saa.channels[i].envelope[1] = right;
+	}
+}
+
+static void SAA_WriteControl(SAA1099 & saa,Bit8u val) {
+	saa.selected_reg = val & 0x1f;
+	if (saa.selected_reg == 0x18 || saa.selected_reg == 0x19) {
+		/* clock the envelope channels */
+		if (saa.env_clock[0]) SAA_Envelope(saa,0);
+		if (saa.env_clock[1]) SAA_Envelope(saa,1);
+	}
+}
+
+static void SAA_WriteData(SAA1099 & saa,Bit8u val) {
+	Bitu reg = saa.selected_reg;
+	switch (reg) {
+	case 0x00: case 0x01: case 0x02: case 0x03: case 0x04: case 0x05:
+		saa.channels[reg].amplitude[0] = amplitude_lookup[val & 0x0f];
+		saa.channels[reg].amplitude[1] = amplitude_lookup[val >> 4];
+		break;
+	case 0x08: case 0x09: case 0x0a: case 0x0b: case 0x0c: case 0x0d:
+		saa.channels[reg & 7].frequency = val;
 		break;
-	case 0:
-		device[0]->data_w(0, 0, val);
+	case 0x10: case 0x11: case 0x12:
+		saa.channels[(reg - 0x10) * 2 + 0].octave = val & 0x07;
+		saa.channels[(reg - 0x10) * 2 + 1].octave = (val >> 4) & 0x07;
 		break;
-	case 3:
-		device[1]->control_w(0, 0, val);
+	case 0x14:
+		for (Bitu i = 0; i < 6; i++) saa.channels[i].freq_enable = (val & (1 << i)) != 0;
 		break;
-	case 2:
-		device[1]->data_w(0, 0, val);
+	case 0x15:
+		for (Bitu i = 0; i < 6; i++) saa.channels[i].noise_enable = (val & (1 << i)) != 0;
+		break;
+	case 0x16:
+		saa.noise_params[0] = val & 0x03;
+		saa.noise_params[1] = (val >> 4) & 0x03;
+		break;
+	case 0x18: case 0x19: {
+		Bitu ch = reg - 0x18;
+		saa.env_reverse_right[ch] = (val & 0x01) != 0;
+		saa.env_mode[ch] = (val >> 1) & 0x07;
+		saa.env_bits[ch] = (val & 0x10) != 0;
+		saa.env_clock[ch] = (val & 0x20) != 0;
+		saa.env_enable[ch] = (val & 0x80) != 0;
+		/* reset the envelope */
+		saa.env_step[ch] = 0;
+		break;
+		}
+	case 0x1c:
+		saa.all_ch_enable = (val & 0x01) != 0;
+		if (val & 0x02) {
+			/* Synch & Reset generators */
+			for (Bitu i = 0; i < 6; i++) {
+				saa.channels[i].level = 0;
+				saa.channels[i].remain = 0;
+			}
+		}
+		break;
+	default:
+		if (val) LOG(LOG_MISC,LOG_NORMAL)("CMS: Unknown register %02X written with %02X",(int)reg,(int)val);
 		break;
 	}
 }
 
-static void CMS_CallBack(Bitu len) {
-	enum {
-		BUFFER_SIZE = 2048
-	};
+static void SAA_Reset(SAA1099 & saa) {
+	memset(&saa,0,sizeof(saa));
+	/* initial state of the noise generators is probably all 1s */
+	saa.noise[0].level = saa.noise[1].level = 0xffffffff;
+}
 
-	if ( len > BUFFER_SIZE )
-		return;
+/* Advance a tone generator by len master clocks, returns the time it spent high and the number of edges passed */
+static INLINE double SAA_Square(SAA1099 & saa,Bitu ch,double len,Bitu & edges) {
+	double high = 0;
+	edges = 0;
+	if (len < saa.channels[ch].remain) {
+		if (saa.channels[ch].level) high = len;
+		saa.channels[ch].remain -= len;
+		return high;
+	}
+	if (saa.channels[ch].level) high = saa.channels[ch].remain;
+	len -= saa.channels[ch].remain;
+	saa.channels[ch].level ^= 1;
+	edges = 1;
+	/* the new frequency only takes effect after the half wave is completed */
+	double half = SAA_HalfPeriod(saa,ch);
+	Bitu count = (Bitu)(len / half);
+	edges += count;
+	if (count & 1) {
+		if (saa.channels[ch].level) high += half;
+		saa.channels[ch].level ^= 1;
+	}
+	high += (count >> 1) * half;
+	len -= count * half;
+	if (saa.channels[ch].level) high += len;
+	saa.channels[ch].remain = half - len;
+	return high;
+}
 
-	if ( cms_chan ) {
+/* Advance a noise generator by len master clocks, returns the time its output was high */
+static INLINE double SAA_Noise(SAA1099 & saa,Bitu ch,double len) {
+	double high = 0;
+	Bit32u level = saa.noise[ch].level;
+	double remain = saa.noise[ch].remain;
+	if (len >= remain) {
+		double period = SAA_NoisePeriod(saa,ch);
+		do {
+			if (level & 1) high += remain;
+			len -= remain;
+			/* polynomial is x^18 + x^11 + x (i.e. 0x20400) and is a plain XOR */
+			if (((level & 0x20000) == 0) != ((level & 0x0400) == 0)) level = (level << 1) | 1;
+			else level <<= 1;
+			remain = period;
+		} while (len >= remain);
+	}
+	if (level & 1) high += len;
+	saa.noise[ch].level = level;
+	saa.noise[ch].remain = remain - len;
+	return high;
+}
 
-		//Have there been 10 seconds of no commands, disable channel
-		if ( lastWriteTicks + 10000 < PIC_Ticks ) {
-			cms_chan->Enable( false );
-			return;
+/* Render len stereo samples, mixing them into the buffer */
+static void SAA_Render(SAA1099 & saa,float * buffer,Bitu len) {
+	/* if the channels are disabled the generators are stopped */
+	if (!saa.all_ch_enable) return;
+	const double span = cms.clocks_per_sample;
+	const float scale = (float)(1.0 / (span * 16 * 6));
+	for (Bitu i = 0; i < len; i++) {
+		float noise[2];
+		noise[0] = (float)SAA_Noise(saa,0,span) * 0.5f;
+		noise[1] = (float)SAA_Noise(saa,1,span) * 0.5f;
+		float left = 0, right = 0;
+		for (Bitu ch = 0; ch < 6; ch++) {
+			Bitu edges;
+			float tone = (float)SAA_Square(saa,ch,span,edges);
+			/* eventually clock the envelope counters */
+			if ((ch == 1 || ch == 4) && !saa.env_clock[ch / 3]) {
+				while (edges--) SAA_Envelope(saa,ch / 3);
+			}
+			float level = 0;
+			if (saa.channels[ch].freq_enable) level += tone;
+			// subtract to avoid overflows, also use only half amplitude
+			if (saa.channels[ch].noise_enable) level -= noise[ch / 3];
+			if (level == 0) continue;
+			left += level * saa.channels[ch].amplitude[0] * saa.channels[ch].envelope[0];
+			right += level * saa.channels[ch].amplitude[1] * saa.channels[ch].envelope[1];
 		}
-		Bit32s result[BUFFER_SIZE][2];
-		Bit16s work[2][BUFFER_SIZE];
-		Bit16s* buffers[2] = { work[0], work[1] };
-		device_sound_interface::sound_stream stream;
-		device[0]->sound_stream_update(stream, 0, buffers, len);
-		for (Bitu i = 0; i < len; i++) {
-			result[i][0] = work[0][i];
-			result[i][1] = work[1][i];
-		}
-		device[1]->sound_stream_update(stream, 0, buffers, len);
-		for (Bitu i = 0; i < len; i++) {
-			result[i][0] += work[0][i];
-			result[i][1] += work[1][i];
+		buffer[i*2+0] += left * scale;
+		buffer[i*2+1] += right * scale;
+	}
+}
+
+static void CMS_Apply(const CmsEntry & entry) {
+	SAA1099 & saa = cms.saa[entry.chip];
+	if (entry.port) SAA_WriteControl(saa,entry.val);
+	else SAA_WriteData(saa,entry.val);
+}
+
+static void write_cms(Bitu port, Bitu val, Bitu /* iolen */) {
+	if(cms.chan && (!cms.chan->enabled)) cms.chan->Enable(true);
+	lastWriteTicks = PIC_Ticks;
+	Bitu reg = port - cmsBase;
+	if (reg > 3) return;
+	CmsEntry entry;
+	entry.index = PIC_TickIndex();
+	entry.chip = (Bit8u)(reg >> 1);
+	entry.port = (Bit8u)(reg & 1);
+	entry.val = (Bit8u)val;
+	if (cms.used == CMS_ENTRIES) {
+		/* Queue is full, catch up with all pending writes */
+		for (Bitu i = 0; i < cms.used; i++) CMS_Apply(cms.entries[i]);
+		cms.used = 0;
+	}
+	cms.entries[cms.used++] = entry;
+}
+
+static void CMS_CallBack(Bitu len) {
+	if ( !cms.chan || len > CMS_MAXSAMPLES )
+		return;
+	float buffer[CMS_MAXSAMPLES*2];
+	memset(buffer,0,len*2*sizeof(float));
+	/* Render up to each queued write, then apply it */
+	Bitu done = 0;
+	for (Bitu i = 0; i < cms.used; i++) {
+		Bitu pos = (Bitu)(cms.entries[i].index * len);
+		if (pos > len) pos = len;
+		if (pos > done) {
+			SAA_Render(cms.saa[0],&buffer[done*2],pos - done);
+			SAA_Render(cms.saa[1],&buffer[done*2],pos - done);
+			done = pos;
 		}
-		cms_chan->AddSamples_s32( len, result[0] );
+		CMS_Apply(cms.entries[i]);
 	}
+	cms.used = 0;
+	//Have there been 10 seconds of no commands, disable channel
+	if ( lastWriteTicks + 10000 < PIC_Ticks ) {
+		cms.chan->Enable( false );
+		return;
+	}
+	SAA_Render(cms.saa[0],&buffer[done*2],len - done);
+	SAA_Render(cms.saa[1],&buffer[done*2],len - done);
+	cms.chan->AddSamples_sfloat( len, buffer );
 }
 
 // The Gameblaster detection
@@ -141,24 +406,19 @@ public:
 		}
 
 		/* Register the Mixer CallBack */
-		cms_chan = MixerChan.Install(CMS_CallBack,sampleRate,"CMS");
+		cms.chan = MixerChan.Install(CMS_CallBack,sampleRate,"CMS");
+		cms.clocks_per_sample = (double)MASTER_CLOCK / sampleRate;
+		cms.used = 0;
 	
 		lastWriteTicks = PIC_Ticks;
 
-		Bit32u freq = 7159000;		//14318180 isa clock / 2
-
-		machine_config config;
-		device[0] = new saa1099_device(config, "", 0, 7159090);
-		device[1] = new saa1099_device(config, "", 0, 7159090);
-
-		device[0]->device_start();
-		device[1]->device_start();
+		SAA_Reset(cms.saa[0]);
+		SAA_Reset(cms.saa[1]);
 	}
 
 	~CMS() {
-		cms_chan = 0;
-		delete device[0];
-		delete device[1];
+		cms.chan = 0;
+		cms.used = 0;
 	}
 };
 
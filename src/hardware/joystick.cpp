@@ -25,6 +25,7 @@
 #include "joystick.h"
 #include "pic.h"
 #include "support.h"
+#include "replay.h"
 
 
 //TODO: higher axis can't be mapped. Find out why again
@@ -239,16 +240,19 @@ static void write_p201_timed(Bitu port,Bitu val,Bitu iolen) {
 }
 
 void JOYSTICK_Enable(Bitu which,bool enabled) {
+	if (!REPLAY_JoystickEnable(which,enabled)) return;
 	if (which<2) stick[which].enabled = enabled;
 }
 
 void JOYSTICK_Button(Bitu which,Bitu num,bool pressed) {
+	if (!REPLAY_JoystickButton(which,num,pressed)) return;
 	if ((which<2) && (num<2)) stick[which].button[num] = pressed;
 }
 
 void JOYSTICK_Move_X(Bitu which,float x) {
 	if (which > 1) return;
 	if (stick[which].xpos == x) return;
+	if (!REPLAY_JoystickMove(which,0,x)) return;
 	stick[which].xpos = x;
 	stick[which].transformed = false;
 //	if( which == 0 || joytype != JOY_FCS)  
@@ -258,6 +262,7 @@ void JOYSTICK_Move_X(Bitu which,float x) {
 void JOYSTICK_Move_Y(Bitu which,float y) {
 	if (which > 1) return;
 	if (stick[which].ypos == y) return;
+	if (!REPLAY_JoystickMove(which,1,y)) return;
 	stick[which].ypos = y;
 	stick[which].transformed = false;
 }
@@ -17,6 +17,7 @@
  */
 
 
+#include <deque>
 #include "dosbox.h"
 #include "keyboard.h"
 #include "inout.h"
@@ -24,8 +25,11 @@
 #include "mem.h"
 #include "mixer.h"
 #include "timer.h"
+#include "bios.h"
+#include "replay.h"
 
 #define KEYBUFSIZE 32
+#define KEYHELDSIZE 256
 #define KEYDELAY 0.300f			//Considering 20-30 khz serial clock and 11 bits/char
 
 enum KeyCommands {
@@ -52,6 +56,15 @@ static struct {
 	bool scheduled;
 } keyb;
 
+/* Key events that found the controller buffer full, because the guest
+ * stopped reading it for a while. They are fed again from the tick handler. */
+struct HeldKey {
+	KBD_KEYS key;
+	bool pressed;
+};
+
+static std::deque<HeldKey> keyheld;
+
 static void KEYBOARD_SetPort60(Bit8u val) {
 	keyb.p60changed=true;
 	keyb.p60data=val;
@@ -72,6 +85,7 @@ static void KEYBOARD_TransferBuffer(Bitu /*val*/) {
 
 
 void KEYBOARD_ClrBuffer(void) {
+	keyheld.clear();
 	keyb.used=0;
 	keyb.pos=0;
 	PIC_RemoveEvents(KEYBOARD_TransferBuffer);
@@ -225,7 +239,7 @@ static Bitu read_p64(Bitu /*port*/,Bitu /*iolen*/) {
 	return status;
 }
 
-void KEYBOARD_AddKey(KBD_KEYS keytype,bool pressed) {
+static void KEYBOARD_PushKey(KBD_KEYS keytype,bool pressed) {
 	Bit8u ret=0;bool extend=false;
 	switch (keytype) {
 	case KBD_esc:ret=1;break;
@@ -373,11 +387,136 @@ void KEYBOARD_AddKey(KBD_KEYS keytype,bool pressed) {
 	KEYBOARD_AddBuffer(ret);
 }
 
+void KEYBOARD_AddKey(KBD_KEYS keytype,bool pressed) {
+	if (!REPLAY_Key(keytype,pressed)) return;
+	/* print screen takes 4 bytes at most, keep the order behind held keys */
+	if (!keyheld.empty() || keyb.used+4>KEYBUFSIZE) {
+		if (keyheld.size()>=KEYHELDSIZE) {
+			LOG(LOG_KEYBOARD,LOG_NORMAL)("Held keys full, dropping key");
+			return;
+		}
+		HeldKey hk;
+		hk.key=keytype;
+		hk.pressed=pressed;
+		keyheld.push_back(hk);
+		return;
+	}
+	KEYBOARD_PushKey(keytype,pressed);
+}
+
+struct ScriptKey {
+	KBD_KEYS key;
+	bool shift;
+	bool direct;		/* may bypass the controller through the BIOS buffer */
+	Bit16u bioscode;	/* scancode<<8 | ascii */
+};
+
+static std::deque<ScriptKey> keyscript;
+
+/* US layout, used to turn script text into key strokes */
+static const struct {
+	char plain,shifted;
+	KBD_KEYS key;
+	Bit8u scan;
+} script_chars[] = {
+	{'1','!',KBD_1,0x02},	{'2','@',KBD_2,0x03},	{'3','#',KBD_3,0x04},
+	{'4','$',KBD_4,0x05},	{'5','%',KBD_5,0x06},	{'6','^',KBD_6,0x07},
+	{'7','&',KBD_7,0x08},	{'8','*',KBD_8,0x09},	{'9','(',KBD_9,0x0a},
+	{'0',')',KBD_0,0x0b},	{'-','_',KBD_minus,0x0c},	{'=','+',KBD_equals,0x0d},
+	{'q','Q',KBD_q,0x10},	{'w','W',KBD_w,0x11},	{'e','E',KBD_e,0x12},
+	{'r','R',KBD_r,0x13},	{'t','T',KBD_t,0x14},	{'y','Y',KBD_y,0x15},
+	{'u','U',KBD_u,0x16},	{'i','I',KBD_i,0x17},	{'o','O',KBD_o,0x18},
+	{'p','P',KBD_p,0x19},	{'[','{',KBD_leftbracket,0x1a},	{']','}',KBD_rightbracket,0x1b},
+	{'a','A',KBD_a,0x1e},	{'s','S',KBD_s,0x1f},	{'d','D',KBD_d,0x20},
+	{'f','F',KBD_f,0x21},	{'g','G',KBD_g,0x22},	{'h','H',KBD_h,0x23},
+	{'j','J',KBD_j,0x24},	{'k','K',KBD_k,0x25},	{'l','L',KBD_l,0x26},
+	{';',':',KBD_semicolon,0x27},	{'\'','"',KBD_quote,0x28},	{'`','~',KBD_grave,0x29},
+	{'\\','|',KBD_backslash,0x2b},	{'z','Z',KBD_z,0x2c},	{'x','X',KBD_x,0x2d},
+	{'c','C',KBD_c,0x2e},	{'v','V',KBD_v,0x2f},	{'b','B',KBD_b,0x30},
+	{'n','N',KBD_n,0x31},	{'m','M',KBD_m,0x32},	{',','<',KBD_comma,0x33},
+	{'.','>',KBD_period,0x34},	{'/','?',KBD_slash,0x35},	{' ',' ',KBD_space,0x39},
+	{'\r','\r',KBD_enter,0x1c},	{'\t','\t',KBD_tab,0x0f},	{'\b','\b',KBD_backspace,0x0e},
+	{'\033','\033',KBD_esc,0x01},
+};
+
+void KEYBOARD_QueueKey(KBD_KEYS keytype,bool shift) {
+	ScriptKey sk;
+	sk.key=keytype;
+	sk.shift=shift;
+	sk.direct=false;
+	sk.bioscode=0;
+	keyscript.push_back(sk);
+}
+
+bool KEYBOARD_QueueText(const char * text,bool bios_direct) {
+	bool all_mapped=true;
+	for (;*text;text++) {
+		/* newline is typed as enter */
+		char c=(*text=='\n') ? '\r' : *text;
+		Bitu i;
+		for (i=0;i<sizeof(script_chars)/sizeof(script_chars[0]);i++) {
+			if (script_chars[i].plain==c || script_chars[i].shifted==c) break;
+		}
+		if (i>=sizeof(script_chars)/sizeof(script_chars[0])) {
+			LOG(LOG_KEYBOARD,LOG_WARN)("Script: no key for character %02X",(Bit8u)c);
+			all_mapped=false;
+			continue;
+		}
+		ScriptKey sk;
+		sk.key=script_chars[i].key;
+		sk.shift=(script_chars[i].plain!=c);
+		sk.direct=bios_direct;
+		sk.bioscode=(script_chars[i].scan<<8)|(Bit8u)c;
+		keyscript.push_back(sk);
+	}
+	return all_mapped;
+}
+
+void KEYBOARD_ClrScript(void) {
+	keyscript.clear();
+}
+
+Bitu KEYBOARD_ScriptPending(void) {
+	return (Bitu)keyscript.size();
+}
+
+/* Move script keys into the controller while there is room for a complete
+ * stroke and the BIOS buffer can take every make code still in flight. */
+static void KEYBOARD_ScriptFeed(void) {
+	while (!keyscript.empty()) {
+		/* shift and an extended key, make and break: 6 bytes at most */
+		if (keyb.used+6>KEYBUFSIZE) return;
+		if (BIOS_KeyboardBufferFree()<=keyb.used) return;
+		ScriptKey sk=keyscript.front();
+		keyscript.pop_front();
+		if (sk.shift) KEYBOARD_PushKey(KBD_leftshift,true);
+		KEYBOARD_PushKey(sk.key,true);
+		KEYBOARD_PushKey(sk.key,false);
+		if (sk.shift) KEYBOARD_PushKey(KBD_leftshift,false);
+	}
+}
+
+void KEYBOARD_ScriptBiosPoll(void) {
+	/* keys already in the controller have to reach the guest first */
+	if (keyb.used || keyb.p60changed || !keyheld.empty()) return;
+	while (!keyscript.empty() && keyscript.front().direct) {
+		if (!BIOS_KeyboardBufferFree()) return;
+		if (!BIOS_AddKeyToBuffer(keyscript.front().bioscode)) return;
+		keyscript.pop_front();
+	}
+}
+
 static void KEYBOARD_TickHandler(void) {
 	if (keyb.repeat.wait) {
 		keyb.repeat.wait--;
-		if (!keyb.repeat.wait) KEYBOARD_AddKey(keyb.repeat.key,true);
+		if (!keyb.repeat.wait) KEYBOARD_PushKey(keyb.repeat.key,true);
+	}
+	while (!keyheld.empty() && keyb.used+4<=KEYBUFSIZE) {
+		KEYBOARD_PushKey(keyheld.front().key,keyheld.front().pressed);
+		keyheld.pop_front();
 	}
+	/* typed keys go first, script keys wait for them */
+	if (!keyscript.empty() && keyheld.empty()) KEYBOARD_ScriptFeed();
 }
 
 void KEYBOARD_Init(Section* /*sec*/) {
@@ -400,4 +539,5 @@ void KEYBOARD_Init(Section* /*sec*/) {
 	keyb.repeat.rate = 33;
 	keyb.repeat.wait = 0;
 	KEYBOARD_ClrBuffer();
+	KEYBOARD_ClrScript();
 }
@@ -28,6 +28,8 @@
 #include "pci_bus.h"
 
 #include <string.h>
+#include <map>
+#include <vector>
 
 #define PAGES_IN_BLOCK	((1024*1024)/MEM_PAGE_SIZE)
 #define SAFE_MEMORY	32
@@ -59,6 +61,13 @@ static struct MemoryBlock {
 	} a20;
 } memory;
 
+/* Free pages from XMS_START on as extents of first page and length */
+typedef std::map<Bitu,Bitu> FreeExtents;
+static FreeExtents mem_free;
+static Bitu mem_free_total;
+/* Pages of an allocation by logical page, built on first lookup of the handle */
+static std::vector<std::vector<MemHandle> > mem_pagelists;
+
 HostPt MemBase;
 
 class IllegalPageHandler : public PageHandler {
@@ -215,76 +224,91 @@ Bitu MEM_TotalPages(void) {
 	return memory.pages;
 }
 
-Bitu MEM_FreeLargest(void) {
-	Bitu size=0;Bitu largest=0;
-	Bitu index=XMS_START;	
-	while (index<memory.pages) {
-		if (!memory.mhandles[index]) {
-			size++;
-		} else {
-			if (size>largest) largest=size;
-			size=0;
+static void MEM_TakeFree(Bitu index,Bitu pages) {
+	FreeExtents::iterator it=mem_free.upper_bound(index);
+	--it;
+	Bitu start=it->first;Bitu end=it->first+it->second;
+	mem_free.erase(it);
+	if (index>start) mem_free[start]=index-start;
+	if (index+pages<end) mem_free[index+pages]=end-index-pages;
+	mem_free_total-=pages;
+}
+
+static void MEM_GiveFree(Bitu index,Bitu pages) {
+	mem_free_total+=pages;
+	FreeExtents::iterator next=mem_free.lower_bound(index);
+	if (next!=mem_free.end() && next->first==index+pages) {
+		pages+=next->second;
+		mem_free.erase(next++);
+	}
+	if (next!=mem_free.begin()) {
+		FreeExtents::iterator prev=next;
+		--prev;
+		if (prev->first+prev->second==index) {
+			prev->second+=pages;
+			return;
+		}
+	}
+	mem_free[index]=pages;
+}
+
+/* Mark a chain of pages as free again, runs of pages go back as one extent */
+static void MEM_FreeChain(MemHandle handle) {
+	Bitu start=0;Bitu pages=0;
+	while (handle>0 && (Bitu)handle<memory.pages) {
+		MemHandle next=memory.mhandles[handle];
+		if (next && (Bitu)handle>=XMS_START) {
+			if (pages && start+pages==(Bitu)handle) pages++;
+			else {
+				if (pages) MEM_GiveFree(start,pages);
+				start=handle;pages=1;
+			}
 		}
-		index++;
+		memory.mhandles[handle]=0;
+		mem_pagelists[handle].clear();
+		handle=next;
+	}
+	if (pages) MEM_GiveFree(start,pages);
+}
+
+static std::vector<MemHandle> & MEM_PageList(MemHandle handle) {
+	std::vector<MemHandle> & list=mem_pagelists[handle];
+	if (list.empty()) {
+		for (MemHandle index=handle;index>0;index=memory.mhandles[index]) list.push_back(index);
+	}
+	return list;
+}
+
+Bitu MEM_FreeLargest(void) {
+	Bitu largest=0;
+	for (FreeExtents::iterator it=mem_free.begin();it!=mem_free.end();++it) {
+		if (it->second>largest) largest=it->second;
 	}
-	if (size>largest) largest=size;
 	return largest;
 }
 
 Bitu MEM_FreeTotal(void) {
-	Bitu free=0;
-	Bitu index=XMS_START;	
-	while (index<memory.pages) {
-		if (!memory.mhandles[index]) free++;
-		index++;
-	}
-	return free;
+	return mem_free_total;
 }
 
 Bitu MEM_AllocatedPages(MemHandle handle) 
 {
-	Bitu pages = 0;
-	while (handle>0) {
-		pages++;
-		handle=memory.mhandles[handle];
-	}
-	return pages;
+	if (handle<=0 || (Bitu)handle>=memory.pages) return 0;
+	return MEM_PageList(handle).size();
 }
 
 //TODO Maybe some protection for this whole allocation scheme
 
+/* First extent that fits exactly, else the smallest one that is large enough */
 INLINE Bitu BestMatch(Bitu size) {
-	Bitu index=XMS_START;	
-	Bitu first=0;
 	Bitu best=0xfffffff;
 	Bitu best_first=0;
-	while (index<memory.pages) {
-		/* Check if we are searching for first free page */
-		if (!first) {
-			/* Check if this is a free page */
-			if (!memory.mhandles[index]) {
-				first=index;	
-			}
-		} else {
-			/* Check if this still is used page */
-			if (memory.mhandles[index]) {
-				Bitu pages=index-first;
-				if (pages==size) {
-					return first;
-				} else if (pages>size) {
-					if (pages<best) {
-						best=pages;
-						best_first=first;
-					}
-				}
-				first=0;			//Always reset for new search
-			}
+	for (FreeExtents::iterator it=mem_free.begin();it!=mem_free.end();++it) {
+		if (it->second==size) return it->first;
+		if (it->second>size && it->second<best) {
+			best=it->second;
+			best_first=it->first;
 		}
-		index++;
-	}
-	/* Check for the final block if we can */
-	if (first && (index-first>=size) && (index-first<best)) {
-		return first;
 	}
 	return best_first;
 }
@@ -295,6 +319,7 @@ MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
 	if (sequence) {
 		Bitu index=BestMatch(pages);
 		if (!index) return 0;
+		MEM_TakeFree(index,pages);
 		MemHandle * next=&ret;
 		while (pages) {
 			*next=index;
@@ -308,7 +333,10 @@ MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
 		while (pages) {
 			Bitu index=BestMatch(1);
 			if (!index) E_Exit("MEM:corruption during allocate");
-			while (pages && (!memory.mhandles[index])) {
+			Bitu run=mem_free[index];
+			if (run>pages) run=pages;
+			MEM_TakeFree(index,run);
+			for (;run>0;run--) {
 				*next=index;
 				next=&memory.mhandles[index];
 				index++;pages--;
@@ -316,6 +344,7 @@ MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
 			*next=-1;		//Invalidate it in case we need another match
 		}
 	}
+	mem_pagelists[ret].clear();
 	return ret;
 }
 
@@ -324,11 +353,7 @@ MemHandle MEM_GetNextFreePage(void) {
 }
 
 void MEM_ReleasePages(MemHandle handle) {
-	while (handle>0) {
-		MemHandle next=memory.mhandles[handle];
-		memory.mhandles[handle]=0;
-		handle=next;
-	}
+	MEM_FreeChain(handle);
 }
 
 bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence) {
@@ -342,46 +367,31 @@ bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence) {
 		handle=-1;
 		return true;
 	}
-	MemHandle index=handle;
-	MemHandle last;Bitu old_pages=0;
-	while (index>0) {
-		old_pages++;
-		last=index;
-		index=memory.mhandles[index];
-	}
+	std::vector<MemHandle> & list=MEM_PageList(handle);
+	Bitu old_pages=list.size();
+	MemHandle last=list[old_pages-1];
 	if (old_pages == pages) return true;
 	if (old_pages > pages) {
 		/* Decrease size */
-		pages--;index=handle;old_pages--;
-		while (pages) {
-			index=memory.mhandles[index];
-			pages--;old_pages--;
-		}
+		MemHandle index=list[pages-1];
 		MemHandle next=memory.mhandles[index];
 		memory.mhandles[index]=-1;
-		index=next;
-		while (old_pages) {
-			next=memory.mhandles[index];
-			memory.mhandles[index]=0;
-			index=next;
-			old_pages--;
-		}
+		list.resize(pages);
+		MEM_FreeChain(next);
 		return true;
 	} else {
 		/* Increase size, check for enough free space */
 		Bitu need=pages-old_pages;
 		if (sequence) {
-			index=last+1;
-			Bitu free=0;
-			while ((index<(MemHandle)memory.pages) && !memory.mhandles[index]) {
-				index++;free++;
-			}
-			if (free>=need) {
+			FreeExtents::iterator it=mem_free.find(last+1);
+			if (it!=mem_free.end() && it->second>=need) {
 				/* Enough space allocate more pages */
-				index=last;
+				MEM_TakeFree(last+1,need);
+				MemHandle index=last;
 				while (need) {
 					memory.mhandles[index]=index+1;
 					need--;index++;
+					list.push_back(index);
 				}
 				memory.mhandles[index]=-1;
 				return true;
@@ -398,6 +408,7 @@ bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence) {
 			MemHandle rem=MEM_AllocatePages(need,false);
 			if (!rem) return false;
 			memory.mhandles[last]=rem;
+			list.clear();
 			return true;
 		}
 	}
@@ -409,6 +420,10 @@ MemHandle MEM_NextHandle(MemHandle handle) {
 }
 
 MemHandle MEM_NextHandleAt(MemHandle handle,Bitu where) {
+	if (handle>0 && (Bitu)handle<memory.pages) {
+		std::vector<MemHandle> & list=MEM_PageList(handle);
+		if (where<list.size()) return list[where];
+	}
 	while (where) {
 		where--;	
 		handle=memory.mhandles[handle];
@@ -579,6 +594,10 @@ public:
 			memory.phandlers[i] = &ram_page_handler;
 			memory.mhandles[i] = 0;				//Set to 0 for memory allocation
 		}
+		mem_free.clear();
+		mem_free_total=0;
+		if (memory.pages>XMS_START) MEM_GiveFree(XMS_START,memory.pages-XMS_START);
+		mem_pagelists.assign(memory.pages,std::vector<MemHandle>());
 		/* Setup rom at 0xc0000-0xc8000 */
 		for (i=0xc0;i<0xc8;i++) {
 			memory.phandlers[i] = &rom_page_handler;
@@ -604,6 +623,8 @@ public:
 		delete [] MemBase;
 		delete [] memory.phandlers;
 		delete [] memory.mhandles;
+		mem_free.clear();
+		mem_pagelists.clear();
 	}
 };	
 
@@ -52,6 +52,7 @@
 #include "hardware.h"
 #include "programs.h"
 #include "midi.h"
+#include "replay.h"
 
 #define MIXER_SSIZE 4
 
@@ -94,6 +95,7 @@ static struct {
 	float mastervol[2];
 	MixerChannel * channels;
 	bool nosound;
+	bool skip_synth;
 	Bit32u freq;
 	Bit32u blocksize;
 } mixer;
@@ -118,6 +120,8 @@ MixerChannel * MIXER_AddChannel(MIXER_Handler handler,Bitu freq,const char * nam
 	chan->SetFreq(freq); //Sets interpolate as well.
 	chan->last_samples_were_silence = true;
 	chan->last_samples_were_stereo = false;
+	chan->synthesized = false;
+	chan->discard = false;
 	chan->offset[0] = 0;
 	chan->offset[1] = 0;
 	mixer.channels = chan;
@@ -186,12 +190,14 @@ void MixerChannel::SetFreq(Bitu freq) {
 
 void MixerChannel::Mix(Bitu _needed) {
 	needed=_needed;
+	discard=mixer.skip_synth && synthesized;
 	while (enabled && needed>done) {
 		Bitu left = (needed - done);
 		left *= freq_add;
 		left  = (left >> FREQ_SHIFT) + ((left & FREQ_MASK)!=0);
 		handler(left);
 	}
+	discard=false;
 }
 
 void MixerChannel::AddSilence(void) {
@@ -240,6 +246,10 @@ void MixerChannel::AddSilence(void) {
 
 template<class Type,bool stereo,bool signeddata,bool nativeorder>
 inline void MixerChannel::AddSamples(Bitu len, const Type* data) {
+	if (GCC_UNLIKELY(discard)) {
+		DiscardSamples(len);
+		return;
+	}
 	last_samples_were_stereo = stereo;
 
 	//Position where to write the data
@@ -379,11 +389,38 @@ inline void MixerChannel::AddSamples(Bitu len, const Type* data) {
 	}
 }
 
+/* Same bookkeeping as AddSamples, so the channel stays in step with the mixer
+ * while the samples the device generated are dropped */
+void MixerChannel::DiscardSamples(Bitu len) {
+	Bitu pos = 0;
+	while (1) {
+		if (freq_counter >= FREQ_NEXT) {
+			Bitu skip = freq_counter >> FREQ_SHIFT;
+			if (skip > len - pos) {
+				freq_counter -= (len - pos) << FREQ_SHIFT;
+				break;
+			}
+			freq_counter -= skip << FREQ_SHIFT;
+			pos += skip;
+		}
+		freq_counter += freq_add;
+		done++;
+	}
+	//Resume from silence once the samples get mixed again
+	prevSample[0] = prevSample[1] = 0;
+	nextSample[0] = nextSample[1] = 0;
+	last_samples_were_silence = true;
+}
+
 void MixerChannel::AddStretched(Bitu len,Bit16s * data) {
 	if (done >= needed) {
 		LOG_MSG("Can't add, buffer full");
 		return;
 	}
+	if (GCC_UNLIKELY(discard)) {
+		done = needed;
+		return;
+	}
 	//Target samples this inputs gets stretched into
 	Bitu outlen = needed - done;
 	Bitu index = 0;
@@ -460,6 +497,37 @@ void MixerChannel::AddSamples_s32_nonnative(Bitu len,const Bit32s * data) {
 	AddSamples<Bit32s,true,true,false>(len,data);
 }
 
+/* Float samples are in the 16 bit range, convert them in blocks and mix those */
+#define MIXER_FLOAT_BLOCK 256
+void MixerChannel::AddSamples_mfloat(Bitu len,const float * data) {
+	if (GCC_UNLIKELY(discard)) {
+		DiscardSamples(len);
+		return;
+	}
+	Bit32s block[MIXER_FLOAT_BLOCK];
+	while (len) {
+		Bitu todo = len > MIXER_FLOAT_BLOCK ? MIXER_FLOAT_BLOCK : len;
+		for (Bitu i = 0; i < todo; i++) block[i] = (Bit32s)data[i];
+		AddSamples<Bit32s,false,true,true>(todo,block);
+		data += todo;
+		len -= todo;
+	}
+}
+void MixerChannel::AddSamples_sfloat(Bitu len,const float * data) {
+	if (GCC_UNLIKELY(discard)) {
+		DiscardSamples(len);
+		return;
+	}
+	Bit32s block[MIXER_FLOAT_BLOCK*2];
+	while (len) {
+		Bitu todo = len > MIXER_FLOAT_BLOCK ? MIXER_FLOAT_BLOCK : len;
+		for (Bitu i = 0; i < todo*2; i++) block[i] = (Bit32s)data[i];
+		AddSamples<Bit32s,true,true,true>(todo,block);
+		data += todo*2;
+		len -= todo;
+	}
+}
+
 void MixerChannel::FillUp(void) {
 	if (!enabled) return;
 
@@ -478,9 +546,9 @@ static inline bool Mixer_irq_important(void) {
 #ifndef __LIBRETRO__
 	/* In some states correct timing of the irqs is more important than
 	 * non stuttering audio */
-	return (ticksLocked || (CaptureState & (CAPTURE_WAVE|CAPTURE_VIDEO)));
+	return (ticksLocked || REPLAY_Active() || (CaptureState & (CAPTURE_WAVE|CAPTURE_VIDEO)));
 #else
-	return ticksLocked;
+	return ticksLocked || REPLAY_Active();
 #endif
 }
 
@@ -834,4 +902,11 @@ auto MIXER_RETRO_GetAvailableFrames() noexcept -> Bitu
 {
 	return mixer.done;
 }
+
+/* Synthesizers are left alone while the output is thrown away anyway. Devices
+ * that are fed by DMA still run, their handlers drive transfers and irqs. */
+void MIXER_RETRO_SkipSynthesis(bool skip)
+{
+	mixer.skip_synth = skip;
+}
 #endif
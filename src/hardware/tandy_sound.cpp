@@ -18,6 +18,10 @@
 
 /* 
 	Based of sn76496.c of the M.A.M.E. project
+
+	Register writes are queued with their position inside the current tick and
+	applied while rendering. The tone and noise generators are advanced from
+	edge to edge, each output sample is the average level over its time.
 */
 
 #include "dosbox.h"
@@ -30,18 +34,44 @@
 #include "hardware.h"
 #include <cstring>
 #include <math.h>
-#include "mame/emu.h"
-#include "mame/sn76496.h"
 
 
 #define SOUND_CLOCK (14318180 / 4)
+/* The generators are clocked at SOUND_CLOCK/2 with a divider of 8 */
+#define PSG_TICKS (SOUND_CLOCK / 16.0)
+#define MAX_OUTPUT 0x7fff
 
 #define TDAC_DMA_BUFSIZE 1024
+#define PSG_ENTRIES 1024
+#define PSG_MAXSAMPLES 2048
+
+struct PsgEntry {
+	float index;
+	Bit8u val;
+};
 
 static struct {
 	MixerChannel * chan;
 	bool enabled;
 	Bitu last_write;
+	struct {
+		/* Chip variant */
+		Bit32u feedback_mask,whitenoise_tap1,whitenoise_tap2;
+		bool negate,ncr_style;
+		Bit32u zero_period;		/* period used when 0 is written */
+		/* Chip state */
+		Bit32u registers[8];
+		Bitu last_register;
+		float volume[4];
+		Bit32u period[4];
+		double remain[4];		/* generator ticks until the next edge */
+		Bit8u output[4];
+		Bit32u rng;
+		float vol_table[16];
+		double ticks_per_sample;
+		PsgEntry entries[PSG_ENTRIES];
+		Bitu used;
+	} psg;
 	struct {
 		MixerChannel * chan;
 		bool enabled;
@@ -63,11 +93,148 @@ static struct {
 	} dac;
 } tandy;
 
-static sn76496_device device_sn76496(machine_config(), 0, 0, SOUND_CLOCK );
-static ncr8496_device device_ncr8496(machine_config(), 0, 0, SOUND_CLOCK);
+static void PSG_Reset(bool pcjr) {
+	if (pcjr) {
+		/* SN76496 */
+		tandy.psg.feedback_mask = 0x10000;
+		tandy.psg.whitenoise_tap1 = 0x04;
+		tandy.psg.whitenoise_tap2 = 0x08;
+		tandy.psg.negate = false;
+		tandy.psg.ncr_style = false;
+		tandy.psg.zero_period = 0x400;
+	} else {
+		/* NCR8496 */
+		tandy.psg.feedback_mask = 0x8000;
+		tandy.psg.whitenoise_tap1 = 0x02;
+		tandy.psg.whitenoise_tap2 = 0x20;
+		tandy.psg.negate = true;
+		tandy.psg.ncr_style = true;
+		tandy.psg.zero_period = 0x400;
+	}
+	/* Both are built like the TI parts, MAME constructs them with sega_style_psg
+	   set: a 0 frequency counts like 0x400. Only the Sega PSGs keep a period of 0. */
+	/* volume = 0x0 (max volume) on reset */
+	for (Bitu i = 0; i < 8; i++) tandy.psg.registers[i] = 0;
+	tandy.psg.last_register = 3;
+	for (Bitu i = 0; i < 4; i++) {
+		tandy.psg.volume[i] = 0;
+		tandy.psg.output[i] = 0;
+		tandy.psg.period[i] = 0;
+		tandy.psg.remain[i] = 0;
+	}
+	tandy.psg.rng = tandy.psg.feedback_mask;
+	tandy.psg.output[3] = tandy.psg.rng & 1;
+	/* four channels, each gets 1/4 of the total range, 2dB per step */
+	float out = MAX_OUTPUT / 4;
+	for (Bitu i = 0; i < 15; i++) {
+		tandy.psg.vol_table[i] = out;
+		out /= 1.258925412f;
+	}
+	tandy.psg.vol_table[15] = 0;
+	tandy.psg.used = 0;
+}
 
-static sn76496_base_device* activeDevice = &device_ncr8496;
-#define device (*activeDevice)
+static void PSG_Write(Bit8u data) {
+	Bitu r;
+	if (data & 0x80) {
+		r = (data & 0x70) >> 4;
+		tandy.psg.last_register = r;
+		if (tandy.psg.ncr_style && (r == 6) && ((data & 0x04) != (tandy.psg.registers[6] & 0x04))) tandy.psg.rng = tandy.psg.feedback_mask;
+		tandy.psg.registers[r] = (tandy.psg.registers[r] & 0x3f0) | (data & 0x0f);
+	} else {
+		r = tandy.psg.last_register;
+		/* NCR8496 ignores writes to regs 1, 3, 5, 6 and 7 with bit 7 clear */
+		if (tandy.psg.ncr_style && ((r & 1) || (r == 6))) return;
+	}
+	Bitu c = r >> 1;
+	switch (r) {
+	case 0: case 2: case 4:		/* tone: frequency */
+		if ((data & 0x80) == 0) tandy.psg.registers[r] = (tandy.psg.registers[r] & 0x0f) | ((data & 0x3f) << 4);
+		tandy.psg.period[c] = tandy.psg.registers[r] ? tandy.psg.registers[r] : tandy.psg.zero_period;
+		/* update noise shift frequency */
+		if ((r == 4) && ((tandy.psg.registers[6] & 0x03) == 0x03)) tandy.psg.period[3] = tandy.psg.period[2] << 1;
+		break;
+	case 1: case 3: case 5: case 7:	/* volume */
+		tandy.psg.volume[c] = tandy.psg.vol_table[data & 0x0f];
+		if ((data & 0x80) == 0) tandy.psg.registers[r] = (tandy.psg.registers[r] & 0x3f0) | (data & 0x0f);
+		break;
+	case 6: {					/* noise: frequency, mode */
+		if ((data & 0x80) == 0) tandy.psg.registers[r] = (tandy.psg.registers[r] & 0x3f0) | (data & 0x0f);
+		Bitu n = tandy.psg.registers[6];
+		/* N/512,N/1024,N/2048,Tone #3 output */
+		tandy.psg.period[3] = ((n & 3) == 3) ? (tandy.psg.period[2] << 1) : (1 << (5 + (n & 3)));
+		if (!tandy.psg.ncr_style) tandy.psg.rng = tandy.psg.feedback_mask;
+		break;
+		}
+	}
+}
+
+/* Advance a tone generator by len ticks, returns the time its output was high */
+static INLINE double PSG_Square(Bitu ch,double len) {
+	double high = 0;
+	double remain = tandy.psg.remain[ch];
+	Bit8u level = tandy.psg.output[ch];
+	if (len < remain) {
+		tandy.psg.remain[ch] = remain - len;
+		return level ? len : 0;
+	}
+	if (level) high = remain;
+	len -= remain;
+	level ^= 1;
+	double half = tandy.psg.period[ch] ? tandy.psg.period[ch] : 1;
+	Bitu count = (Bitu)(len / half);
+	if (count & 1) {
+		if (level) high += half;
+		level ^= 1;
+	}
+	high += (count >> 1) * half;
+	len -= count * half;
+	if (level) high += len;
+	tandy.psg.output[ch] = level;
+	tandy.psg.remain[ch] = half - len;
+	return high;
+}
+
+/* Advance the noise generator by len ticks, returns the time its output was high */
+static INLINE double PSG_Noise(double len) {
+	double high = 0;
+	double remain = tandy.psg.remain[3];
+	if (len >= remain) {
+		double period = tandy.psg.period[3] ? tandy.psg.period[3] : 1;
+		/* if noisemode is 1, both taps are enabled
+		   if noisemode is 0, the lower tap, whitenoisetap2, is held at 0 */
+		bool noise_mode = (tandy.psg.registers[6] & 4) != 0;
+		Bit32u tap2_high = tandy.psg.ncr_style ? tandy.psg.whitenoise_tap2 : 0;
+		do {
+			if (tandy.psg.output[3]) high += remain;
+			len -= remain;
+			Bit32u rng = tandy.psg.rng;
+			bool feed = ((rng & tandy.psg.whitenoise_tap1) != 0) != (((rng & tandy.psg.whitenoise_tap2) != tap2_high) && noise_mode);
+			rng >>= 1;
+			if (feed) rng |= tandy.psg.feedback_mask;
+			tandy.psg.rng = rng;
+			tandy.psg.output[3] = rng & 1;
+			remain = period;
+		} while (len >= remain);
+	}
+	if (tandy.psg.output[3]) high += len;
+	tandy.psg.remain[3] = remain - len;
+	return high;
+}
+
+static void PSG_Render(float * buffer,Bitu len) {
+	const double span = tandy.psg.ticks_per_sample;
+	const float scale = (float)((tandy.psg.negate ? -1.0 : 1.0) / span);
+	for (Bitu i = 0; i < len; i++) {
+		float out = 0;
+		for (Bitu ch = 0; ch < 3; ch++) {
+			float high = (float)PSG_Square(ch,span);
+			out += high * tandy.psg.volume[ch];
+		}
+		out += (float)PSG_Noise(span) * tandy.psg.volume[3];
+		buffer[i] = out * scale;
+	}
+}
 
 static void SN76496Write(Bitu /*port*/,Bitu data,Bitu /*iolen*/) {
 	tandy.last_write=PIC_Ticks;
@@ -75,27 +242,42 @@ static void SN76496Write(Bitu /*port*/,Bitu data,Bitu /*iolen*/) {
 		tandy.chan->Enable(true);
 		tandy.enabled=true;
 	}
-	device.write(data);
+	if (tandy.psg.used == PSG_ENTRIES) {
+		/* Queue is full, catch up with all pending writes */
+		for (Bitu i = 0; i < tandy.psg.used; i++) PSG_Write(tandy.psg.entries[i].val);
+		tandy.psg.used = 0;
+	}
+	tandy.psg.entries[tandy.psg.used].index = PIC_TickIndex();
+	tandy.psg.entries[tandy.psg.used].val = (Bit8u)data;
+	tandy.psg.used++;
 
 //	LOG_MSG("3voice write %X at time %7.3f",data,PIC_FullIndex());
 }
 
 static void SN76496Update(Bitu length) {
+	if (length > PSG_MAXSAMPLES)
+		return;
+	float buffer[PSG_MAXSAMPLES];
+	/* Render up to each queued write, then apply it */
+	Bitu done = 0;
+	for (Bitu i = 0; i < tandy.psg.used; i++) {
+		Bitu pos = (Bitu)(tandy.psg.entries[i].index * length);
+		if (pos > length) pos = length;
+		if (pos > done) {
+			PSG_Render(&buffer[done],pos - done);
+			done = pos;
+		}
+		PSG_Write(tandy.psg.entries[i].val);
+	}
+	tandy.psg.used = 0;
 	//Disable the channel if it's been quiet for a while
 	if ((tandy.last_write+5000)<PIC_Ticks) {
 		tandy.enabled=false;
 		tandy.chan->Enable(false);
 		return;
 	}
-	const Bitu MAX_SAMPLES = 2048;
-	if (length > MAX_SAMPLES)
-		return;
-	Bit16s buffer[MAX_SAMPLES];
-	Bit16s* outputs = buffer;
-
-	device_sound_interface::sound_stream stream;
-	static_cast<device_sound_interface&>(device).sound_stream_update(stream, 0, &outputs, length);
-	tandy.chan->AddSamples_m16(length, buffer);
+	PSG_Render(&buffer[done],length - done);
+	tandy.chan->AddSamples_mfloat(length, buffer);
 }
 
 bool TS_Get_Address(Bitu& tsaddr, Bitu& tsirq, Bitu& tsdma) {
@@ -277,8 +459,7 @@ public:
 		}
 
 		//Select the correct tandy chip implementation
-		if (machine == MCH_PCJR) activeDevice = &device_sn76496;
-		else activeDevice = &device_ncr8496;
+		PSG_Reset(machine == MCH_PCJR);
 
 		real_writeb(0x40,0xd4,0x00);
 		if (IS_TANDY_ARCH) {
@@ -336,9 +517,7 @@ public:
 		tandy.enabled=false;
 		real_writeb(0x40,0xd4,0xff);	/* BIOS Tandy DAC initialization value */
 
-		((device_t&)device).device_start();
-		device.convert_samplerate(sample_rate);
-
+		tandy.psg.ticks_per_sample = PSG_TICKS / sample_rate;
 	}
 	~TANDYSOUND(){ }
 };
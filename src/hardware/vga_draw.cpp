@@ -27,6 +27,7 @@
 #include "pic.h"
 
 #ifdef __LIBRETRO__
+#include <chrono>
 #include "CoreOptions.h"
 #include "libretro_core_options.h"
 #include "pinhack.h"
@@ -717,6 +718,11 @@ static void VGA_DrawEGASingleLine(Bitu /*blah*/) {
 }
 
 static void VGA_DrawPart(Bitu lines) {
+#ifdef __LIBRETRO__
+	// Host time spent drawing and scaling feeds the adaptive frameskip
+	std::chrono::steady_clock::time_point draw_start;
+	if (render.frameskip.timeDraw) draw_start = std::chrono::steady_clock::now();
+#endif
 	while (lines--) {
 		Bit8u * data=VGA_DrawLine( vga.draw.address, vga.draw.address_line );
 		RENDER_DrawLine(data);
@@ -742,6 +748,10 @@ static void VGA_DrawPart(Bitu lines) {
 		}
 #endif
 	}
+#ifdef __LIBRETRO__
+	if (render.frameskip.timeDraw) render.frameskip.drawTime +=
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - draw_start).count();
+#endif
 	if (--vga.draw.parts_left) {
 		PIC_AddEvent(VGA_DrawPart,(float)vga.draw.delay.parts,
 			 (vga.draw.parts_left!=1) ? vga.draw.parts_lines  : (vga.draw.lines_total - vga.draw.lines_done));
@@ -2545,127 +2545,267 @@ nextpixel:
 
 
 
-/*************************************
- *
- *  Voodoo texture RAM writes
- *
- *************************************/
-
-INT32 texture_w(UINT32 offset, UINT32 data) {
-	int tmunum = (offset >> 19) & 0x03;
-	LOG(LOG_VOODOO,LOG_WARN)("V3D:write TMU%x offset %X value %X", tmunum, offset, data);
-
-	tmu_state *t;
-
-	/* point to the right TMU */
-	if (!(v->chipmask & (2 << tmunum)))
-		return 0;
-	t = &v->tmu[tmunum];
-
-	if (TEXLOD_TDIRECT_WRITE(t->reg[tLOD].u))
-		E_Exit("Texture direct write!");
-
-	/* update texture info if dirty */
-	if (t->regdirty)
-		recompute_texture_params(t);
-
-	/* swizzle the data */
-	if (TEXLOD_TDATA_SWIZZLE(t->reg[tLOD].u))
-		data = FLIPENDIAN_INT32(data);
-	if (TEXLOD_TDATA_SWAP(t->reg[tLOD].u))
-		data = (data >> 16) | (data << 16);
+/* LFB stores that bypass the pixel pipeline, a run of dwords in a single
+   write format. MODE is LFBMODE_WRITE_FORMAT + 16 * LFBMODE_RGBA_LANES so
+   the extraction and the presence checks fold away per format; the result
+   matches lfb_w with all bytes enabled. */
+template<UINT32 MODE>
+static void lfb_w_raw_run(UINT32 offset, const UINT32 *src, UINT32 count) {
+	const UINT32 lfbmode = v->reg[lfbMode].u;
+	const UINT32 fbzmode = v->reg[fbzMode].u;
+	const bool pairs = (MODE & 0x0f) < 4 || (MODE & 0x0f) == 15;
+	const bool swizzle = LFBMODE_BYTE_SWIZZLE_WRITES(lfbmode) > 0;
+	const bool swap = LFBMODE_WORD_SWAP_WRITES(lfbmode) > 0;
+	const bool alpha_planes = FBZMODE_ENABLE_ALPHA_PLANES(fbzmode) > 0;
+	const int def_w = v->reg[zaColor].u & 0xffff;
+	const int def_a = v->reg[zaColor].u >> 24;
+	DECLARE_DITHER_POINTERS;
 
-	/* 8-bit texture case */
-	if (TEXMODE_FORMAT(t->reg[textureMode].u) < 8)
+	UINT32 rgboffs;
+	switch (LFBMODE_WRITE_BUFFER_SELECT(lfbmode))
 	{
-		int lod, tt, ts;
-		UINT32 tbaseaddr;
-		UINT8 *dest;
+		case 0:			/* front buffer */
+			rgboffs = v->fbi.rgboffs[v->fbi.frontbuf];
+			break;
 
-		/* extract info */
-		lod = (offset >> 15) & 0x0f;
-		tt = (offset >> 7) & 0xff;
+		case 1:			/* back buffer */
+			rgboffs = v->fbi.rgboffs[v->fbi.backbuf];
+			break;
 
-		/* old code has a bit about how this is broken in gauntleg unless we always look at TMU0 */
-		if (TEXMODE_SEQ_8_DOWNLD(v->tmu[0].reg/*t->reg*/[textureMode].u))
-			ts = (offset << 2) & 0xfc;
-		else
-			ts = (offset << 1) & 0xfc;
+		default:		/* reserved */
+			E_Exit("reserved lfb write");
+			return;
+	}
+	UINT16 *dest = (UINT16 *)(v->fbi.ram + rgboffs);
+	UINT32 destmax = (v->fbi.mask + 1 - rgboffs) / 2;
+	UINT16 *depth = (UINT16 *)(v->fbi.ram + v->fbi.auxoffs);
+	UINT32 depthmax = (v->fbi.mask + 1 - v->fbi.auxoffs) / 2;
 
-		/* validate parameters */
-		if (lod > 8)
-			return 0;
+	int lasty = -1, scry = 0;
+	for (UINT32 i = 0; i < count; i++)
+	{
+		UINT32 data = src[i];
+
+		/* byte swizzling and word swapping */
+		if (swizzle)
+			data = FLIPENDIAN_INT32(data);
+		if (swap)
+			data = (data << 16) | (data >> 16);
+
+		/* compute X,Y */
+		UINT32 pixoffs = pairs ? (offset + i) << 1 : offset + i;
+		int x = pixoffs & ((1 << 10) - 1);
+		int y = (pixoffs >> 10) & ((1 << 10) - 1);
+		if (y != lasty)
+		{
+			lasty = y;
+			scry = y;
+			if (LFBMODE_Y_ORIGIN(lfbmode))
+				scry = (v->fbi.yorigin - y) & 0x3ff;
+			COMPUTE_DITHER_POINTERS(fbzmode, y);
+		}
+		UINT32 bufoffs = scry * v->fbi.rowpixels + x;
 
-		/* compute the base address */
-		tbaseaddr = t->lodoffset[lod];
-		tbaseaddr += tt * ((t->wmask >> lod) + 1) + ts;
+		for (int pix = 0; pix < (pairs ? 2 : 1); pix++, x++, bufoffs++)
+		{
+			UINT32 pdata = pix ? (data >> 16) : data;
+			int sr = 0, sg = 0, sb = 0, sa = def_a, sw = def_w;
+			bool has_rgb = true, has_alpha = false, has_depth = false;
 
-		if (LOG_TEXTURE_RAM) LOG(LOG_VOODOO,LOG_WARN)("Texture 8-bit w: lod=%d s=%d t=%d data=%08X\n", lod, ts, tt, data);
+			switch (MODE)
+			{
+				case 16*0 + 0:		/* ARGB, 16-bit RGB 5-6-5 */
+				case 16*2 + 0:		/* RGBA, 16-bit RGB 5-6-5 */
+					EXTRACT_565_TO_888(pdata, sr, sg, sb);
+					break;
+				case 16*1 + 0:		/* ABGR, 16-bit RGB 5-6-5 */
+				case 16*3 + 0:		/* BGRA, 16-bit RGB 5-6-5 */
+					EXTRACT_565_TO_888(pdata, sb, sg, sr);
+					break;
+				case 16*0 + 1:		/* ARGB, 16-bit RGB x-5-5-5 */
+					EXTRACT_x555_TO_888(pdata, sr, sg, sb);
+					break;
+				case 16*0 + 2:		/* ARGB, 16-bit ARGB 1-5-5-5 */
+					EXTRACT_1555_TO_8888(pdata, sa, sr, sg, sb);
+					has_alpha = alpha_planes;
+					break;
+				case 16*0 + 4:		/* ARGB, 32-bit RGB x-8-8-8 */
+					EXTRACT_x888_TO_888(pdata, sr, sg, sb);
+					break;
+				case 16*0 + 5:		/* ARGB, 32-bit ARGB 8-8-8-8 */
+					EXTRACT_8888_TO_8888(pdata, sa, sr, sg, sb);
+					has_alpha = alpha_planes;
+					break;
+				case 16*0 + 15:		/* 16-bit depth */
+					sw = pdata & 0xffff;
+					has_rgb = false;
+					has_depth = !alpha_planes;
+					break;
+			}
 
-		/* write the four bytes in little-endian order */
-		dest = t->ram;
-		tbaseaddr &= t->mask;
+			/* write to the RGB buffer */
+			if (has_rgb && bufoffs < destmax)
+			{
+				/* apply dithering and write to the screen */
+				APPLY_DITHER(fbzmode, x, dither_lookup, sr, sg, sb);
+				dest[bufoffs] = (UINT16)((sr << 11) | (sg << 5) | sb);
+			}
 
-		bool changed = false;
-		if (dest[BYTE4_XOR_LE(tbaseaddr + 0)] != ((data >> 0) & 0xff)) {
-			dest[BYTE4_XOR_LE(tbaseaddr + 0)] = (data >> 0) & 0xff;
-			changed = true;
-		}
-		if (dest[BYTE4_XOR_LE(tbaseaddr + 1)] != ((data >> 8) & 0xff)) {
-			dest[BYTE4_XOR_LE(tbaseaddr + 1)] = (data >> 8) & 0xff;
-			changed = true;
-		}
-		if (dest[BYTE4_XOR_LE(tbaseaddr + 2)] != ((data >> 16) & 0xff)) {
-			dest[BYTE4_XOR_LE(tbaseaddr + 2)] = (data >> 16) & 0xff;
-			changed = true;
-		}
-		if (dest[BYTE4_XOR_LE(tbaseaddr + 3)] != ((data >> 24) & 0xff)) {
-			dest[BYTE4_XOR_LE(tbaseaddr + 3)] = (data >> 24) & 0xff;
-			changed = true;
+			/* write to the alpha or depth buffer */
+			if (bufoffs < depthmax)
+			{
+				if (has_alpha)
+					depth[bufoffs] = (UINT16)sa;
+				if (has_depth)
+					depth[bufoffs] = (UINT16)sw;
+			}
 		}
 
-		if (changed && v->ogl && v->active) {
-			voodoo_ogl_texture_clear(t->lodoffset[lod],tmunum);
-			voodoo_ogl_texture_clear(t->lodoffset[t->lodmin],tmunum);
-		}
+		/* track pixel writes to the frame buffer regardless of mask */
+		v->reg[fbiPixelsOut].u += pairs ? 2 : 1;
 	}
+}
 
-	/* 16-bit texture case */
-	else
+/* the formats that get their own loop; the rest go through lfb_w */
+static bool lfb_w_run(UINT32 offset, const UINT32 *src, UINT32 count) {
+	switch (LFBMODE_WRITE_FORMAT(v->reg[lfbMode].u) + 16 * LFBMODE_RGBA_LANES(v->reg[lfbMode].u))
 	{
-		int lod, tt, ts;
-		UINT32 tbaseaddr;
-		UINT16 *dest;
+		case 16*0 + 0:
+		case 16*2 + 0:	lfb_w_raw_run<16*0 + 0>(offset, src, count); return true;
+		case 16*1 + 0:
+		case 16*3 + 0:	lfb_w_raw_run<16*1 + 0>(offset, src, count); return true;
+		case 16*0 + 1:	lfb_w_raw_run<16*0 + 1>(offset, src, count); return true;
+		case 16*0 + 2:	lfb_w_raw_run<16*0 + 2>(offset, src, count); return true;
+		case 16*0 + 4:	lfb_w_raw_run<16*0 + 4>(offset, src, count); return true;
+		case 16*0 + 5:	lfb_w_raw_run<16*0 + 5>(offset, src, count); return true;
+		case 16*0 + 15:
+		case 16*1 + 15:
+		case 16*2 + 15:
+		case 16*3 + 15:	lfb_w_raw_run<16*0 + 15>(offset, src, count); return true;
+	}
+	return false;
+}
 
-		/* extract info */
-		tmunum = (offset >> 19) & 0x03;
-		lod = (offset >> 15) & 0x0f;
-		tt = (offset >> 7) & 0xff;
-		ts = (offset << 1) & 0xfe;
 
-		/* validate parameters */
-		if (lod > 8)
-			return 0;
 
-		/* compute the base address */
-		tbaseaddr = t->lodoffset[lod];
-		tbaseaddr += 2 * (tt * ((t->wmask >> lod) + 1) + ts);
+/*************************************
+ *
+ *  Voodoo texture RAM writes
+ *
+ *************************************/
 
-		if (LOG_TEXTURE_RAM) LOG(LOG_VOODOO,LOG_WARN)("Texture 16-bit w: lod=%d s=%d t=%d data=%08X\n", lod, ts, tt, data);
+/* a run of dwords starting at offset; TMU and LOD are decoded per run so
+   that a download costs one setup per mipmap level rather than per dword */
+static void texture_w_run(UINT32 offset, const UINT32 *src, UINT32 count) {
+	while (count) {
+		/* the TMU and LOD live above bit 15 of the offset */
+		UINT32 seg = 0x8000 - (offset & 0x7fff);
+		if (seg > count) seg = count;
+
+		int tmunum = (offset >> 19) & 0x03;
+		int lod = (offset >> 15) & 0x0f;
+		LOG(LOG_VOODOO,LOG_WARN)("V3D:write TMU%x offset %X count %X", tmunum, offset, seg);
+
+		tmu_state *t;
+		UINT32 first = offset;
+		const UINT32 *data = src;
+		offset += seg;
+		src += seg;
+		count -= seg;
+
+		/* point to the right TMU */
+		if (!(v->chipmask & (2 << tmunum)))
+			continue;
+		t = &v->tmu[tmunum];
+
+		if (TEXLOD_TDIRECT_WRITE(t->reg[tLOD].u))
+			E_Exit("Texture direct write!");
+
+		/* update texture info if dirty */
+		if (t->regdirty)
+			recompute_texture_params(t);
 
-		/* write the two words in little-endian order */
-		dest = (UINT16 *)t->ram;
-		tbaseaddr &= t->mask;
-		tbaseaddr >>= 1;
+		/* validate parameters */
+		if (lod > 8)
+			continue;
 
+		bool swizzle = TEXLOD_TDATA_SWIZZLE(t->reg[tLOD].u) > 0;
+		bool swap = TEXLOD_TDATA_SWAP(t->reg[tLOD].u) > 0;
+		UINT32 rowbase = (t->wmask >> lod) + 1;
 		bool changed = false;
-		if (dest[BYTE_XOR_LE(tbaseaddr + 0)] != ((data >> 0) & 0xffff)) {
-			dest[BYTE_XOR_LE(tbaseaddr + 0)] = (data >> 0) & 0xffff;
-			changed = true;
+
+		/* 8-bit texture case */
+		if (TEXMODE_FORMAT(t->reg[textureMode].u) < 8)
+		{
+			UINT8 *dest = t->ram;
+			/* old code has a bit about how this is broken in gauntleg unless we always look at TMU0 */
+			int tshift = TEXMODE_SEQ_8_DOWNLD(v->tmu[0].reg/*t->reg*/[textureMode].u) ? 2 : 1;
+
+			for (UINT32 i = 0; i < seg; i++)
+			{
+				UINT32 cur = first + i;
+				UINT32 val = data[i];
+				int tt = (cur >> 7) & 0xff;
+				int ts = (cur << tshift) & 0xfc;
+
+				/* swizzle the data */
+				if (swizzle)
+					val = FLIPENDIAN_INT32(val);
+				if (swap)
+					val = (val >> 16) | (val << 16);
+
+				/* compute the base address */
+				UINT32 tbaseaddr = t->lodoffset[lod] + tt * rowbase + ts;
+
+				if (LOG_TEXTURE_RAM) LOG(LOG_VOODOO,LOG_WARN)("Texture 8-bit w: lod=%d s=%d t=%d data=%08X\n", lod, ts, tt, val);
+
+				/* write the four bytes in little-endian order */
+				tbaseaddr &= t->mask;
+				for (int b = 0; b < 4; b++) {
+					UINT8 byte = (val >> (b * 8)) & 0xff;
+					if (dest[BYTE4_XOR_LE(tbaseaddr + b)] != byte) {
+						dest[BYTE4_XOR_LE(tbaseaddr + b)] = byte;
+						changed = true;
+					}
+				}
+			}
 		}
-		if (dest[BYTE_XOR_LE(tbaseaddr + 1)] != ((data >> 16) & 0xffff)) {
-			dest[BYTE_XOR_LE(tbaseaddr + 1)] = (data >> 16) & 0xffff;
-			changed = true;
+
+		/* 16-bit texture case */
+		else
+		{
+			UINT16 *dest = (UINT16 *)t->ram;
+
+			for (UINT32 i = 0; i < seg; i++)
+			{
+				UINT32 cur = first + i;
+				UINT32 val = data[i];
+				int tt = (cur >> 7) & 0xff;
+				int ts = (cur << 1) & 0xfe;
+
+				/* swizzle the data */
+				if (swizzle)
+					val = FLIPENDIAN_INT32(val);
+				if (swap)
+					val = (val >> 16) | (val << 16);
+
+				/* compute the base address */
+				UINT32 tbaseaddr = t->lodoffset[lod] + 2 * (tt * rowbase + ts);
+
+				if (LOG_TEXTURE_RAM) LOG(LOG_VOODOO,LOG_WARN)("Texture 16-bit w: lod=%d s=%d t=%d data=%08X\n", lod, ts, tt, val);
+
+				/* write the two words in little-endian order */
+				tbaseaddr &= t->mask;
+				tbaseaddr >>= 1;
+				if (dest[BYTE_XOR_LE(tbaseaddr + 0)] != (val & 0xffff)) {
+					dest[BYTE_XOR_LE(tbaseaddr + 0)] = val & 0xffff;
+					changed = true;
+				}
+				if (dest[BYTE_XOR_LE(tbaseaddr + 1)] != (val >> 16)) {
+					dest[BYTE_XOR_LE(tbaseaddr + 1)] = val >> 16;
+					changed = true;
+				}
+			}
 		}
 
 		if (changed && v->ogl && v->active) {
@@ -2673,7 +2813,10 @@ INT32 texture_w(UINT32 offset, UINT32 data) {
 			voodoo_ogl_texture_clear(t->lodoffset[t->lodmin],tmunum);
 		}
 	}
+}
 
+INT32 texture_w(UINT32 offset, UINT32 data) {
+	texture_w_run(offset, &data, 1);
 	return 0;
 }
 
@@ -2871,7 +3014,64 @@ UINT32 lfb_r(UINT32 offset)
 }
 
 
+/*************************************
+ *
+ *  Write combining
+ *
+ *************************************/
+
+/* Full dword stores to consecutive LFB or texture addresses are collected
+   and converted in one pass. Nothing but the display and the card's own
+   registers can observe them, so every other access flushes first. */
+#define WRITE_RUN_MAX		1024
+
+enum {
+	WRITE_RUN_LFB = 1,
+	WRITE_RUN_TEXTURE
+};
+
+static struct {
+	int kind;
+	UINT32 start;
+	UINT32 count;
+	UINT32 data[WRITE_RUN_MAX];
+} write_run;
+
+void voodoo_flush_writes(void) {
+	if (!write_run.count) return;
+	UINT32 count = write_run.count;
+	write_run.count = 0;
+	if (write_run.kind == WRITE_RUN_TEXTURE)
+		texture_w_run(write_run.start, write_run.data, count);
+	else if (!lfb_w_run(write_run.start, write_run.data, count))
+	{
+		for (UINT32 i = 0; i < count; i++)
+			lfb_w(write_run.start + i, write_run.data[i], 0xffffffff);
+	}
+}
+
 void voodoo_w(UINT32 offset, UINT32 data, UINT32 mask) {
+	if (mask == 0xffffffff && (offset & (0xc00000/4)) != 0)
+	{
+		int kind = (offset & (0x800000/4)) ? WRITE_RUN_TEXTURE : WRITE_RUN_LFB;
+
+		/* the pixel pipeline and the OpenGL path keep the direct route */
+		if (kind == WRITE_RUN_TEXTURE || (!LFBMODE_ENABLE_PIXEL_PIPELINE(v->reg[lfbMode].u) && !(v->ogl && v->active)))
+		{
+			if (write_run.count && (write_run.kind != kind || write_run.start + write_run.count != offset ||
+				write_run.count == WRITE_RUN_MAX))
+				voodoo_flush_writes();
+			if (!write_run.count)
+			{
+				write_run.kind = kind;
+				write_run.start = offset;
+			}
+			write_run.data[write_run.count++] = data;
+			return;
+		}
+	}
+
+	voodoo_flush_writes();
 	if ((offset & (0xc00000/4)) == 0)
 		register_w(offset, data);
 	else if ((offset & (0x800000/4)) == 0)
@@ -2881,6 +3081,7 @@ void voodoo_w(UINT32 offset, UINT32 data, UINT32 mask) {
 }
 
 UINT32 voodoo_r(UINT32 offset) {
+	voodoo_flush_writes();
 	if ((offset & (0xc00000/4)) == 0)
 		return register_r(offset);
 	else if ((offset & (0x800000/4)) == 0)
@@ -2901,6 +3102,7 @@ UINT32 voodoo_r(UINT32 offset) {
 
 void voodoo_init(int type) {
 	v->active = false;
+	write_run.count = 0;
 
 	v->type = VOODOO_1;
 
@@ -3069,6 +3271,7 @@ void voodoo_init(int type) {
 }
 
 void voodoo_shutdown() {
+	write_run.count = 0;
 	if (v->ogl)
 		voodoo_ogl_shutdown(v);
 
@@ -109,6 +109,7 @@ void Voodoo_PageHandler::writed(PhysPt addr,Bitu val) {
 
 static void Voodoo_VerticalTimer(Bitu /*val*/) {
 	vdraw.frame_start = PIC_FullIndex();
+	voodoo_flush_writes();
 	PIC_AddEvent( Voodoo_VerticalTimer, vdraw.vfreq );
 
 	if (v->fbi.vblank_flush_pending) {
@@ -185,6 +186,8 @@ double Voodoo_GetHRetracePosition() {
 }
 
 static void Voodoo_UpdateScreen(void) {
+	voodoo_flush_writes();
+
 	// abort drawing
 	RENDER_EndUpdate(true);
 
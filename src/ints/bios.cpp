@@ -31,6 +31,7 @@
 #include "mouse.h"
 #include "setup.h"
 #include "serialport.h"
+#include "replay.h"
 #ifdef __LIBRETRO__
 #include "libretro.h"
 #endif
@@ -551,6 +552,8 @@ static void BIOS_HostTimeSync() {
 	loctime->tm_mon = 2-1;
 	loctime->tm_year = 2007 - 1900;
 	*/
+	struct tm replaytime;
+	if (REPLAY_LocalTime(replaytime,milli)) loctime=&replaytime;
 
 	dos.date.day=(Bit8u)loctime->tm_mday;
 	dos.date.month=(Bit8u)loctime->tm_mon+1;
@@ -162,6 +162,24 @@ bool BIOS_AddKeyToBuffer(Bit16u code) {
 	return true;
 }
 
+Bitu BIOS_KeyboardBufferFree(void) {
+	Bit16u start,end,head,tail;
+	if (machine==MCH_PCJR) {
+		start=0x1e;
+		end=0x3e;
+	} else {
+		start=mem_readw(BIOS_KEYBOARD_BUFFER_START);
+		end	 =mem_readw(BIOS_KEYBOARD_BUFFER_END);
+	}
+	head =mem_readw(BIOS_KEYBOARD_BUFFER_HEAD);
+	tail =mem_readw(BIOS_KEYBOARD_BUFFER_TAIL);
+	if (end<=start) return 0;
+	Bitu slots=(end-start)/2;
+	Bitu used=(tail>=head) ? (tail-head)/2 : slots-(head-tail)/2;
+	/* one slot always stays empty to tell a full buffer from an empty one */
+	return (used+1<slots) ? slots-used-1 : 0;
+}
+
 static void add_key(Bit16u code) {
 	if (code!=0) BIOS_AddKeyToBuffer(code);
 }
@@ -502,6 +520,12 @@ static bool IsEnhancedKey(Bit16u &key) {
 static Bitu INT16_Handler(void) {
 	Bit16u temp=0;
 	switch (reg_ah) {
+	case 0x00: case 0x10: case 0x01: case 0x11:
+		/* guest is polling the BIOS buffer, let scripted text skip the controller */
+		KEYBOARD_ScriptBiosPoll();
+		break;
+	}
+	switch (reg_ah) {
 	case 0x00: /* GET KEYSTROKE */
 		if ((get_key(temp)) && (!IsEnhancedKey(temp))) {
 			/* normal key found, return translated key in ax */
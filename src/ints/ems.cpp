@@ -294,6 +294,12 @@ static Bit8u EMM_ReallocatePages(Bit16u handle,Bit16u & pages) {
 	return EMM_NO_ERROR;
 }
 
+/* PAGING_MapPage already resets the tlb entries of the remapped pages, only with
+   paging enabled other linear pages can point at the old memory */
+static void EMM_FlushTLB(void) {
+	if (PAGING_Enabled()) PAGING_ClearTLB();
+}
+
 static Bit8u EMM_MapPage(Bitu phys_page,Bit16u handle,Bit16u log_page) {
 //	LOG_MSG("EMS MapPage handle %d phys %d log %d",handle,phys_page,log_page);
 	/* Check for too high physical page */
@@ -306,7 +312,7 @@ static Bit8u EMM_MapPage(Bitu phys_page,Bit16u handle,Bit16u log_page) {
 		emm_mappings[phys_page].page=NULL_PAGE;
 		for (Bitu i=0;i<4;i++)
 			PAGING_MapPage(EMM_PAGEFRAME4K+phys_page*4+i,EMM_PAGEFRAME4K+phys_page*4+i);
-		PAGING_ClearTLB();
+		EMM_FlushTLB();
 		return EMM_NO_ERROR;
 	}
 	/* Check for valid handle */
@@ -317,12 +323,9 @@ static Bit8u EMM_MapPage(Bitu phys_page,Bit16u handle,Bit16u log_page) {
 		emm_mappings[phys_page].handle=handle;
 		emm_mappings[phys_page].page=log_page;
 
-		MemHandle memh=MEM_NextHandleAt(emm_handles[handle].mem,log_page*4);;
-		for (Bitu i=0;i<4;i++) {
-			PAGING_MapPage(EMM_PAGEFRAME4K+phys_page*4+i,memh);
-			memh=MEM_NextHandle(memh);
-		}
-		PAGING_ClearTLB();
+		for (Bitu i=0;i<4;i++)
+			PAGING_MapPage(EMM_PAGEFRAME4K+phys_page*4+i,MEM_NextHandleAt(emm_handles[handle].mem,log_page*4+i));
+		EMM_FlushTLB();
 		return EMM_NO_ERROR;
 	} else  {
 		/* Illegal logical page it is */
@@ -364,7 +367,7 @@ static Bit8u EMM_MapSegment(Bitu segment,Bit16u handle,Bit16u log_page) {
 			}
 			for (Bitu i=0;i<4;i++)
 				PAGING_MapPage(segment*16/4096+i,segment*16/4096+i);
-			PAGING_ClearTLB();
+			EMM_FlushTLB();
 			return EMM_NO_ERROR;
 		}
 		/* Check for valid handle */
@@ -380,12 +383,9 @@ static Bit8u EMM_MapSegment(Bitu segment,Bit16u handle,Bit16u log_page) {
 				emm_segmentmappings[segment>>10].page=log_page;
 			}
 
-			MemHandle memh=MEM_NextHandleAt(emm_handles[handle].mem,log_page*4);;
-			for (Bitu i=0;i<4;i++) {
-				PAGING_MapPage(segment*16/4096+i,memh);
-				memh=MEM_NextHandle(memh);
-			}
-			PAGING_ClearTLB();
+			for (Bitu i=0;i<4;i++)
+				PAGING_MapPage(segment*16/4096+i,MEM_NextHandleAt(emm_handles[handle].mem,log_page*4+i));
+			EMM_FlushTLB();
 			return EMM_NO_ERROR;
 		} else  {
 			/* Illegal logical page it is */
@@ -645,7 +645,7 @@ static Bit8u MemoryRegion(void) {
 		if ((emm_handles[region.src_handle].pages*EMM_PAGE_SIZE) < ((region.src_page_seg*EMM_PAGE_SIZE)+region.src_offset+region.bytes)) return EMM_LOG_OUT_RANGE;
 		src_handle=emm_handles[region.src_handle].mem;
 		Bitu pages=region.src_page_seg*4+(region.src_offset/MEM_PAGE_SIZE);
-		for (;pages>0;pages--) src_handle=MEM_NextHandle(src_handle);
+		src_handle=MEM_NextHandleAt(src_handle,pages);
 		src_off=region.src_offset&(MEM_PAGE_SIZE-1);
 		src_remain=MEM_PAGE_SIZE-src_off;
 	}
@@ -656,7 +656,7 @@ static Bit8u MemoryRegion(void) {
 		if (emm_handles[region.dest_handle].pages*EMM_PAGE_SIZE < (region.dest_page_seg*EMM_PAGE_SIZE)+region.dest_offset+region.bytes) return EMM_LOG_OUT_RANGE;
 		dest_handle=emm_handles[region.dest_handle].mem;
 		Bitu pages=region.dest_page_seg*4+(region.dest_offset/MEM_PAGE_SIZE);
-		for (;pages>0;pages--) dest_handle=MEM_NextHandle(dest_handle);
+		dest_handle=MEM_NextHandleAt(dest_handle,pages);
 		dest_off=region.dest_offset&(MEM_PAGE_SIZE-1);
 		dest_remain=MEM_PAGE_SIZE-dest_off;
 	}
@@ -32,6 +32,7 @@
 #include "int10.h"
 #include "bios.h"
 #include "dos_inc.h"
+#include "replay.h"
 
 static Bitu call_int33,call_int74,int74_ret_callback,call_mouse_bd;
 static Bit16u ps2cbseg,ps2cbofs;
@@ -466,6 +467,7 @@ void DrawCursor() {
 }
 
 void Mouse_CursorMoved(float xrel,float yrel,float x,float y,bool emulate) {
+	if (!REPLAY_MouseMoved(xrel,yrel,x,y,emulate)) return;
 	float dx = xrel * mouse.pixelPerMickey_x;
 	float dy = yrel * mouse.pixelPerMickey_y;
 
@@ -524,6 +526,7 @@ void Mouse_CursorSet(float x,float y) {
 }
 
 void Mouse_ButtonPressed(Bit8u button) {
+	if (!REPLAY_MouseButton(button,true)) return;
 	switch (button) {
 #if (MOUSE_BUTTONS >= 1)
 	case 0:
@@ -555,6 +558,7 @@ void Mouse_ButtonPressed(Bit8u button) {
 }
 
 void Mouse_ButtonReleased(Bit8u button) {
+	if (!REPLAY_MouseButton(button,false)) return;
 	switch (button) {
 #if (MOUSE_BUTTONS >= 1)
 	case 0:
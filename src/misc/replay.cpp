@@ -0,0 +1,467 @@
+/*
+ *  Copyright (C) 2002-2021  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Records host input stamped with the emulated time and feeds it back at
+ * the same emulated instants. With fixed cycles the guest then runs the
+ * same instruction stream on every replay; periodic hashes of RAM and
+ * video memory taken while recording are checked during replay to prove
+ * it. Input arriving while recording is held back and delivered at the
+ * start of the next millisecond on the emulation thread, so it does not
+ * depend on where the frontend happened to interrupt the emulation. The
+ * guest's wall clock (BIOS tick count, CMOS) runs on emulated time from
+ * the local time the recording was started at. The log is plain text,
+ * one event per line:
+ *
+ *   C <cycles>                          cycles per millisecond
+ *   T <seconds>                         local start time, seconds since 1970
+ *   K <tick> <index> <key> <pressed>    keyboard
+ *   M <tick> <index> <xrel> <yrel> <x> <y> <emulate>
+ *   B <tick> <index> <button> <pressed> mouse button
+ *   N <tick> <index> <stick> <enabled>  joystick enable
+ *   J <tick> <index> <stick> <button> <pressed>
+ *   A <tick> <index> <stick> <axis> <value>
+ *   H <tick> <ram hash> <video memory hash>
+ *   Z <tick>                            end of the recording
+ *
+ * tick is PIC_Ticks, index the cycle within that millisecond. Floats are
+ * stored as their bit pattern so they come back unchanged. */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <mutex>
+#include <vector>
+
+#include "dosbox.h"
+#include "replay.h"
+#include "setup.h"
+#include "pic.h"
+#include "timer.h"
+#include "cpu.h"
+#include "mem.h"
+#include "vga.h"
+#include "keyboard.h"
+#include "mouse.h"
+#include "joystick.h"
+
+struct ReplayEvent {
+	char type;
+	Bitu tick;
+	Bits index;
+	Bitu a,b;
+	bool flag;
+	float f[4];
+};
+
+struct ReplayHash {
+	Bitu tick;
+	Bit64u ram,vram;
+};
+
+static struct {
+	FILE * record;
+	bool replaying;
+	bool injecting;
+	bool started;
+	bool finished;
+	Bit32s cycles;
+	Bitu hash_interval;
+	Bitu end_tick;
+	Bitu start_host;
+	Bit64s start_time;
+	std::mutex lock;
+	std::vector<ReplayEvent> pending;
+	std::vector<ReplayEvent> events;
+	Bitu next_event;
+	std::vector<ReplayHash> hashes;
+	Bitu next_hash;
+	Bitu hash_fails;
+} replay;
+
+static Bit32u float_bits(float val) {
+	Bit32u bits;
+	memcpy(&bits,&val,sizeof(bits));
+	return bits;
+}
+
+static float bits_float(Bit32u bits) {
+	float val;
+	memcpy(&val,&bits,sizeof(val));
+	return val;
+}
+
+/* Current local time as seconds since 1970, so it converts back with gmtime */
+static Bit64s REPLAY_LocalSeconds(void) {
+	time_t now=time(NULL);
+	const struct tm * loctime=localtime(&now);
+	Bit64s y=loctime->tm_year+1900;
+	Bit64s m=loctime->tm_mon+1;
+	if (m<=2) y--;
+	Bit64s era=(y>=0?y:y-399)/400;
+	Bit64s yoe=y-era*400;
+	Bit64s doy=(153*(m>2?m-3:m+9)+2)/5+loctime->tm_mday-1;
+	Bit64s days=era*146097+yoe*365+yoe/4-yoe/100+doy-719468;
+	return days*86400+loctime->tm_hour*3600+loctime->tm_min*60+loctime->tm_sec;
+}
+
+static Bit64u REPLAY_HashBlock(const Bit8u * data,Bitu size,Bit64u hash) {
+	Bitu words=size/8;
+	for (Bitu i=0;i<words;i++) {
+		Bit64u val;
+		memcpy(&val,data+i*8,8);
+		hash=(hash^val)*0x100000001b3ULL;
+		hash^=hash>>29;
+	}
+	for (Bitu i=words*8;i<size;i++) hash=(hash^data[i])*0x100000001b3ULL;
+	return hash;
+}
+
+static void REPLAY_Hash(Bit64u & ram,Bit64u & vram) {
+	ram=REPLAY_HashBlock(MemBase,MEM_TotalPages()*4096,0xcbf29ce484222325ULL);
+	vram=REPLAY_HashBlock(vga.mem.linear,vga.vmemsize,0xcbf29ce484222325ULL);
+}
+
+/* Cycle counts decide where every event lands, so they stay fixed at the
+ * value the recording started with. Called at the start of a tick. */
+static void REPLAY_FixCycles(void) {
+	if (!replay.started) {
+		replay.started=true;
+		replay.start_host=GetTicks();
+		if (replay.record) {
+			replay.cycles=CPU_CycleMax;
+			fprintf(replay.record,"C %d\n",(int)replay.cycles);
+		}
+		if (CPU_CycleAutoAdjust || CPU_CycleMax!=replay.cycles)
+			LOG_MSG("REPLAY: Using fixed %d cycles",(int)replay.cycles);
+	}
+	if (CPU_CycleAutoAdjust || CPU_CycleMax!=replay.cycles) {
+		CPU_CycleAutoAdjust=false;
+		CPU_CycleMax=replay.cycles;
+		CPU_CycleLeft=CPU_CycleMax;
+		CPU_Cycles=0;
+	}
+}
+
+/* Live input is dropped while a recording is replayed */
+static bool REPLAY_Live(void) {
+	return !replay.replaying || replay.finished || replay.injecting;
+}
+
+/* Recorded input is held back until the next tick, see REPLAY_Flush */
+static bool REPLAY_Hold(const ReplayEvent & ev) {
+	if (replay.injecting) return true;
+	if (!replay.record) return REPLAY_Live();
+	std::lock_guard<std::mutex> guard(replay.lock);
+	replay.pending.push_back(ev);
+	return false;
+}
+
+static ReplayEvent REPLAY_Event(char type,Bitu a,Bitu b,bool flag) {
+	ReplayEvent ev;
+	memset(&ev,0,sizeof(ev));
+	ev.type=type;
+	ev.a=a;
+	ev.b=b;
+	ev.flag=flag;
+	return ev;
+}
+
+bool REPLAY_Key(Bitu keytype,bool pressed) {
+	return REPLAY_Hold(REPLAY_Event('K',keytype,0,pressed));
+}
+
+bool REPLAY_MouseMoved(float xrel,float yrel,float x,float y,bool emulate) {
+	ReplayEvent ev=REPLAY_Event('M',0,0,emulate);
+	ev.f[0]=xrel;
+	ev.f[1]=yrel;
+	ev.f[2]=x;
+	ev.f[3]=y;
+	return REPLAY_Hold(ev);
+}
+
+bool REPLAY_MouseButton(Bit8u button,bool pressed) {
+	return REPLAY_Hold(REPLAY_Event('B',button,0,pressed));
+}
+
+bool REPLAY_JoystickEnable(Bitu which,bool enabled) {
+	return REPLAY_Hold(REPLAY_Event('N',which,0,enabled));
+}
+
+bool REPLAY_JoystickButton(Bitu which,Bitu num,bool pressed) {
+	return REPLAY_Hold(REPLAY_Event('J',which,num,pressed));
+}
+
+bool REPLAY_JoystickMove(Bitu which,Bitu axis,float val) {
+	ReplayEvent ev=REPLAY_Event('A',which,axis,false);
+	ev.f[0]=val;
+	return REPLAY_Hold(ev);
+}
+
+bool REPLAY_Active(void) {
+	return replay.record || (replay.replaying && !replay.finished);
+}
+
+bool REPLAY_LocalTime(struct tm & loctime,Bit32u & milli) {
+	if (!replay.record && !replay.replaying) return false;
+	time_t now=(time_t)(replay.start_time+(Bit64s)(PIC_Ticks/1000));
+	loctime=*gmtime(&now);
+	milli=(Bit32u)(PIC_Ticks%1000);
+	return true;
+}
+
+static void REPLAY_Deliver(const ReplayEvent & ev) {
+	replay.injecting=true;
+	switch (ev.type) {
+	case 'K':
+		KEYBOARD_AddKey((KBD_KEYS)ev.a,ev.flag);
+		break;
+	case 'M':
+		Mouse_CursorMoved(ev.f[0],ev.f[1],ev.f[2],ev.f[3],ev.flag);
+		break;
+	case 'B':
+		if (ev.flag) Mouse_ButtonPressed((Bit8u)ev.a);
+		else Mouse_ButtonReleased((Bit8u)ev.a);
+		break;
+	case 'N':
+		JOYSTICK_Enable(ev.a,ev.flag);
+		break;
+	case 'J':
+		JOYSTICK_Button(ev.a,ev.b,ev.flag);
+		break;
+	case 'A':
+		if (ev.b) JOYSTICK_Move_Y(ev.a,ev.f[0]);
+		else JOYSTICK_Move_X(ev.a,ev.f[0]);
+		break;
+	}
+	replay.injecting=false;
+}
+
+static void REPLAY_Inject(Bitu val) {
+	REPLAY_Deliver(replay.events[val]);
+}
+
+/* Log and deliver the input that arrived during the last millisecond */
+static void REPLAY_Flush(void) {
+	std::vector<ReplayEvent> events;
+	{
+		std::lock_guard<std::mutex> guard(replay.lock);
+		events.swap(replay.pending);
+	}
+	for (const ReplayEvent & ev : events) {
+		fprintf(replay.record,"%c %u 0",ev.type,(Bit32u)PIC_Ticks);
+		switch (ev.type) {
+		case 'K': case 'B': case 'N':
+			fprintf(replay.record," %u %d\n",(Bit32u)ev.a,ev.flag?1:0);
+			break;
+		case 'J':
+			fprintf(replay.record," %u %u %d\n",(Bit32u)ev.a,(Bit32u)ev.b,ev.flag?1:0);
+			break;
+		case 'A':
+			fprintf(replay.record," %u %u %08x\n",(Bit32u)ev.a,(Bit32u)ev.b,float_bits(ev.f[0]));
+			break;
+		case 'M':
+			fprintf(replay.record," %08x %08x %08x %08x %d\n",float_bits(ev.f[0]),float_bits(ev.f[1]),
+				float_bits(ev.f[2]),float_bits(ev.f[3]),ev.flag?1:0);
+			break;
+		}
+		REPLAY_Deliver(ev);
+	}
+}
+
+static void REPLAY_Finish(void) {
+	replay.finished=true;
+	LOG_MSG("REPLAY: Finished at %u ms emulated time after %u ms, %u of %u hash checks failed",
+		(Bit32u)PIC_Ticks,(Bit32u)(GetTicks()-replay.start_host),
+		(Bit32u)replay.hash_fails,(Bit32u)replay.hashes.size());
+}
+
+static void REPLAY_TickHandler(void) {
+	if (replay.finished) return;
+	REPLAY_FixCycles();
+	if (replay.record) {
+		REPLAY_Flush();
+		if (replay.hash_interval && (PIC_Ticks%replay.hash_interval)==0) {
+			Bit64u ram,vram;
+			REPLAY_Hash(ram,vram);
+			fprintf(replay.record,"H %u %016llx %016llx\n",(Bit32u)PIC_Ticks,
+				(unsigned long long)ram,(unsigned long long)vram);
+		}
+		return;
+	}
+	/* Schedule everything that happens within this millisecond */
+	while (replay.next_event<replay.events.size() &&
+	       replay.events[replay.next_event].tick<=PIC_Ticks) {
+		const ReplayEvent & ev=replay.events[replay.next_event];
+		if (ev.tick==PIC_Ticks && ev.index==0) REPLAY_Deliver(ev);
+		else {
+			float delay=(ev.tick==PIC_Ticks)?(ev.index/(float)CPU_CycleMax):0.0f;
+			PIC_AddEvent(REPLAY_Inject,delay,replay.next_event);
+		}
+		replay.next_event++;
+	}
+	while (replay.next_hash<replay.hashes.size() &&
+	       replay.hashes[replay.next_hash].tick<=PIC_Ticks) {
+		const ReplayHash & check=replay.hashes[replay.next_hash++];
+		if (check.tick!=PIC_Ticks) continue;
+		Bit64u ram,vram;
+		REPLAY_Hash(ram,vram);
+		if (ram!=check.ram || vram!=check.vram) {
+			if (!replay.hash_fails)
+				LOG_MSG("REPLAY: State diverged at %u ms (%s differs)",(Bit32u)PIC_Ticks,
+					ram!=check.ram?"memory":"video memory");
+			replay.hash_fails++;
+		}
+	}
+	if (PIC_Ticks>=replay.end_tick) REPLAY_Finish();
+}
+
+static bool REPLAY_Load(const char * name) {
+	FILE * f=fopen(name,"rt");
+	if (!f) {
+		LOG_MSG("REPLAY: Can't open %s",name);
+		return false;
+	}
+	char line[256];
+	Bitu lineno=0;
+	bool have_time=false;
+	replay.end_tick=0;
+	while (fgets(line,sizeof(line),f)) {
+		lineno++;
+		ReplayEvent ev;
+		memset(&ev,0,sizeof(ev));
+		ev.type=line[0];
+		unsigned int tick=0,a=0,b=0,bits[4]={0,0,0,0};
+		int index=0,flag=0,cycles=0;
+		unsigned long long ram=0,vram=0;
+		long long start=0;
+		int ok=0;
+		switch (ev.type) {
+		case 'C':
+			if (sscanf(line+1,"%d",&cycles)==1 && cycles>0) {
+				replay.cycles=cycles;
+				continue;
+			}
+			break;
+		case 'T':
+			if (sscanf(line+1,"%lld",&start)==1) {
+				replay.start_time=start;
+				have_time=true;
+				continue;
+			}
+			break;
+		case 'K': case 'B': case 'N':
+			ok=(sscanf(line+1,"%u %d %u %d",&tick,&index,&a,&flag)==4);
+			break;
+		case 'J':
+			ok=(sscanf(line+1,"%u %d %u %u %d",&tick,&index,&a,&b,&flag)==5);
+			break;
+		case 'A':
+			ok=(sscanf(line+1,"%u %d %u %u %x",&tick,&index,&a,&b,&bits[0])==5);
+			break;
+		case 'M':
+			ok=(sscanf(line+1,"%u %d %x %x %x %x %d",&tick,&index,
+				&bits[0],&bits[1],&bits[2],&bits[3],&flag)==7);
+			break;
+		case 'H':
+			if (sscanf(line+1,"%u %llx %llx",&tick,&ram,&vram)==3) {
+				ReplayHash hash={tick,ram,vram};
+				replay.hashes.push_back(hash);
+				if (tick>replay.end_tick) replay.end_tick=tick;
+				continue;
+			}
+			break;
+		case 'Z':
+			if (sscanf(line+1,"%u",&tick)==1) {
+				replay.end_tick=tick;
+				continue;
+			}
+			break;
+		}
+		if (!ok) {
+			LOG_MSG("REPLAY: Bad line %u in %s",(Bit32u)lineno,name);
+			continue;
+		}
+		ev.tick=tick;
+		ev.index=index;
+		ev.a=a;
+		ev.b=b;
+		ev.flag=(flag!=0);
+		for (int i=0;i<4;i++) ev.f[i]=bits_float(bits[i]);
+		replay.events.push_back(ev);
+		if (tick>replay.end_tick) replay.end_tick=tick;
+	}
+	fclose(f);
+	if (!replay.cycles) {
+		LOG_MSG("REPLAY: %s has no cycles setting",name);
+		return false;
+	}
+	if (!have_time) {
+		LOG_MSG("REPLAY: %s has no start time, memory checks will fail",name);
+		replay.start_time=REPLAY_LocalSeconds();
+	}
+	LOG_MSG("REPLAY: Replaying %u events from %s",(Bit32u)replay.events.size(),name);
+	return true;
+}
+
+static void REPLAY_Destroy(Section* /*sec*/) {
+	TIMER_DelTickHandler(REPLAY_TickHandler);
+	PIC_RemoveEvents(REPLAY_Inject);
+	if (replay.record) {
+		fprintf(replay.record,"Z %u\n",(Bit32u)PIC_Ticks);
+		fclose(replay.record);
+		replay.record=0;
+	}
+	if (replay.replaying && !replay.finished) REPLAY_Finish();
+	replay.replaying=false;
+	replay.events.clear();
+	replay.hashes.clear();
+	replay.pending.clear();
+}
+
+void REPLAY_Init(Section* sec) {
+	Section_prop * section=static_cast<Section_prop *>(sec);
+	replay.record=0;
+	replay.replaying=false;
+	replay.injecting=false;
+	replay.started=false;
+	replay.finished=false;
+	replay.cycles=0;
+	replay.next_event=0;
+	replay.next_hash=0;
+	replay.hash_fails=0;
+	replay.hash_interval=(Bitu)section->Get_int("replayhash");
+
+	std::string replayfile=section->Get_path("inputreplay")->realpath;
+	std::string recordfile=section->Get_path("inputrecord")->realpath;
+	if (!replayfile.empty()) {
+		if (!recordfile.empty()) LOG_MSG("REPLAY: Replaying, inputrecord is ignored");
+		replay.replaying=REPLAY_Load(replayfile.c_str());
+		if (!replay.replaying) return;
+	} else if (!recordfile.empty()) {
+		replay.record=fopen(recordfile.c_str(),"wt");
+		if (!replay.record) {
+			LOG_MSG("REPLAY: Can't create %s",recordfile.c_str());
+			return;
+		}
+		replay.start_time=REPLAY_LocalSeconds();
+		fprintf(replay.record,"T %lld\n",(long long)replay.start_time);
+		LOG_MSG("REPLAY: Recording input to %s",recordfile.c_str());
+	} else return;
+	TIMER_AddTickHandler(REPLAY_TickHandler);
+	sec->AddDestroyFunction(&REPLAY_Destroy,false);
+}
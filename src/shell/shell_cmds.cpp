@@ -818,10 +818,12 @@ void DOS_Shell::CMD_COPY(char * args) {
 							static Bit8u buffer[0x8000]; // static, otherwise stack overflow possible.
 							bool	failed = false;
 							Bit16u	toread = 0x8000;
+							// The first block goes through the file handlers (overlay copy on write),
+							// the rest is copied on the host when both files live there
 							do {
 								failed |= DOS_ReadFile(sourceHandle,buffer,&toread);
 								failed |= DOS_WriteFile(targetHandle,buffer,&toread);
-							} while (toread==0x8000);
+							} while (toread==0x8000 && !DOS_CopyFileRest(sourceHandle,targetHandle));
 							failed |= DOS_CloseFile(sourceHandle);
 							failed |= DOS_CloseFile(targetHandle);
 							WriteOut(" %s\n",name);